@@ -0,0 +1,77 @@
+#pragma once
+
+// Replaces the global allocation functions with ones that count calls and bytes. Include
+// from exactly one translation unit of a benchmark executable.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+namespace AllocationCounter
+{
+	inline std::atomic<uint64_t> count{ 0 };
+	inline std::atomic<uint64_t> bytes{ 0 };
+
+	inline void* Checked(void* memory)
+	{
+		if (!memory)
+		{
+			throw std::bad_alloc();
+		}
+		return memory;
+	}
+
+	inline void* Allocate(size_t size)
+	{
+		count.fetch_add(1, std::memory_order_relaxed);
+		bytes.fetch_add(size, std::memory_order_relaxed);
+		return Checked(std::malloc(size ? size : 1));
+	}
+
+	// Memory from here must be released with FreeAligned: MSVC has no aligned_alloc, and
+	// its _aligned_malloc blocks cannot be passed to free.
+	inline void* AllocateAligned(size_t size, size_t alignment)
+	{
+		count.fetch_add(1, std::memory_order_relaxed);
+		bytes.fetch_add(size, std::memory_order_relaxed);
+		size = size ? size : 1;
+#if defined(_MSC_VER)
+		return Checked(_aligned_malloc(size, alignment));
+#else
+		return Checked(std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment));
+#endif
+	}
+
+	inline void FreeAligned(void* memory)
+	{
+#if defined(_MSC_VER)
+		_aligned_free(memory);
+#else
+		std::free(memory);
+#endif
+	}
+
+	struct Snapshot
+	{
+		uint64_t count = AllocationCounter::count.load(std::memory_order_relaxed);
+		uint64_t bytes = AllocationCounter::bytes.load(std::memory_order_relaxed);
+	};
+}
+
+void* operator new(size_t size) { return AllocationCounter::Allocate(size); }
+void* operator new[](size_t size) { return AllocationCounter::Allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return AllocationCounter::AllocateAligned(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return AllocationCounter::AllocateAligned(size, static_cast<size_t>(alignment)); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { AllocationCounter::FreeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { AllocationCounter::FreeAligned(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { AllocationCounter::FreeAligned(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { AllocationCounter::FreeAligned(memory); }
@@ -0,0 +1,351 @@
+// ECS micro-benchmarks: entity creation and destruction, prefab instantiation, component
+// add/remove, tagging, single- and multi-component iteration (serial and chunk-parallel),
+// tag-filtered iteration, parallel reduction, random access, snapshot save/load and
+// rollback save/restore, from 1k to 10M entities. Reports ns/op, global allocator calls
+// per op and, for iteration, the component bytes streamed per entity and the effective
+// bandwidth, so cache regressions show up as GB/s drops.
+// Usage: ecs_bench [--max N] [--json path|-]
+
+#include "../src/engine/ecs/include/ECSManager.h"
+#include "../src/engine/ecs/include/RollbackBuffer.h"
+#include "../src/engine/ecs/include/WorldSnapshot.h"
+#include "AllocationCounter.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct Position : Component
+	{
+		static constexpr bool Persistent = true;
+		float x = 0.0f, y = 0.0f, z = 0.0f;
+	};
+
+	struct Velocity : Component
+	{
+		static constexpr bool Persistent = true;
+		float x = 1.0f, y = 1.0f, z = 1.0f;
+	};
+
+	struct Health : Component
+	{
+		static constexpr bool Persistent = true;
+		int32_t value = 100;
+	};
+
+	struct Static : Component
+	{
+	};
+
+	struct Result
+	{
+		std::string name;
+		size_t entities = 0;
+		double nsPerOp = 0.0;
+		double allocationsPerOp = 0.0;
+		double allocatedBytesPerOp = 0.0;
+		// Component bytes read or written per entity; zero for structural operations.
+		size_t bytesPerEntity = 0;
+	};
+
+	volatile float sink;
+
+	class Runner
+	{
+	public:
+		explicit Runner(size_t entities) : entities(entities) {}
+
+		// Times func, which performs ops operations, and records the result.
+		template <typename Func>
+		void Measure(const char* name, size_t ops, size_t bytesPerEntity, Func&& func)
+		{
+			const AllocationCounter::Snapshot before;
+			auto start = std::chrono::steady_clock::now();
+			func();
+			auto end = std::chrono::steady_clock::now();
+			const AllocationCounter::Snapshot after;
+
+			const double count = static_cast<double>(std::max<size_t>(ops, 1));
+			Result result;
+			result.name = name;
+			result.entities = entities;
+			result.nsPerOp = std::chrono::duration<double, std::nano>(end - start).count() / count;
+			result.allocationsPerOp = static_cast<double>(after.count - before.count) / count;
+			result.allocatedBytesPerOp = static_cast<double>(after.bytes - before.bytes) / count;
+			result.bytesPerEntity = bytesPerEntity;
+			results.push_back(result);
+		}
+
+		std::vector<Result> results;
+
+	private:
+		size_t entities;
+	};
+
+	void RunSuite(size_t count, std::vector<Result>& results)
+	{
+		Runner runner(count);
+		ECSManager ecsManager;
+		std::vector<Entity> entities;
+		entities.reserve(count);
+
+		std::vector<size_t> order(count);
+		std::iota(order.begin(), order.end(), size_t(0));
+		std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+		runner.Measure("create", count, 0, [&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				entities.push_back(ecsManager.CreateEntity());
+			}
+		});
+
+		runner.Measure("add_component", count * 2, 0, [&]
+		{
+			for (Entity entity : entities)
+			{
+				ecsManager.AddComponent<Position>(entity);
+				ecsManager.AddComponent<Velocity>(entity);
+			}
+		});
+
+		runner.Measure("iterate_single", count, sizeof(Position), [&]
+		{
+			ecsManager.Each<Position>([](Entity, Position& position)
+			{
+				position.x += 1.0f;
+			});
+		});
+
+		runner.Measure("iterate_multi", count, sizeof(Position) + sizeof(Velocity), [&]
+		{
+			ecsManager.Each<Position, const Velocity>([](Entity, Position& position, const Velocity& velocity)
+			{
+				position.x += velocity.x;
+				position.y += velocity.y;
+				position.z += velocity.z;
+			});
+		});
+
+		runner.Measure("iterate_range_for", count, sizeof(Position) + sizeof(Velocity), [&]
+		{
+			for (auto [entity, position, velocity] : ecsManager.View<Position, const Velocity>())
+			{
+				position.x += velocity.x;
+			}
+		});
+
+		// Same work as iterate_multi, a chunk per job; compare to see scaling with cores.
+		// Workers are started outside the timed region.
+		ecsManager.GetJobSystem();
+		runner.Measure("iterate_parallel", count, sizeof(Position) + sizeof(Velocity), [&]
+		{
+			ecsManager.ParallelForEach<Position, const Velocity>([](Entity, Position& position, const Velocity& velocity)
+			{
+				position.x += velocity.x;
+				position.y += velocity.y;
+				position.z += velocity.z;
+			});
+		});
+
+		runner.Measure("reduce_parallel", count, sizeof(Position), [&]
+		{
+			sink = ecsManager.View<const Position>().ParallelReduce(ecsManager.GetJobSystem(), 0.0f,
+				[](float& sum, Entity, const Position& position) { sum += position.x; },
+				[](float& sum, float partial) { sum += partial; });
+		});
+
+		runner.Measure("random_access", count, sizeof(Position), [&]
+		{
+			float sum = 0.0f;
+			for (size_t index : order)
+			{
+				sum += ecsManager.ReadComponent<Position>(entities[index])->x;
+			}
+			sink = sum;
+		});
+
+		// Each add moves the entity's two existing components to a new archetype.
+		runner.Measure("add_component_move", count, 0, [&]
+		{
+			for (Entity entity : entities)
+			{
+				ecsManager.AddComponent<Health>(entity);
+			}
+		});
+
+		runner.Measure("remove_component", count, 0, [&]
+		{
+			for (Entity entity : entities)
+			{
+				ecsManager.RemoveComponent<Health>(entity);
+			}
+		});
+
+		// Round trip through a file; load maps it and copies columns into fresh chunks.
+		const std::string snapshotPath = (std::filesystem::temp_directory_path() / "ecs_bench.snapshot").string();
+		runner.Measure("snapshot_save", count, sizeof(Position) + sizeof(Velocity), [&]
+		{
+			WorldSnapshot::Save(ecsManager, snapshotPath);
+		});
+
+		ECSManager loadedWorld;
+		runner.Measure("snapshot_load", count, sizeof(Position) + sizeof(Velocity), [&]
+		{
+			WorldSnapshot::Load(loadedWorld, snapshotPath);
+		});
+		std::filesystem::remove(snapshotPath);
+
+		// A tick after writing every 16th position: only touched chunks are delta encoded
+		// against the first save. Restore then rewinds to that first save.
+		RollbackBuffer rollback(8);
+		rollback.Save(ecsManager, 1);
+		for (size_t i = 0; i < count; i += 16)
+		{
+			ecsManager.GetComponent<Position>(entities[i])->x += 1.0f;
+		}
+		runner.Measure("rollback_save", count, 0, [&]
+		{
+			rollback.Save(ecsManager, 2);
+		});
+
+		runner.Measure("rollback_restore", count, 0, [&]
+		{
+			rollback.Restore(ecsManager, 1);
+		});
+
+		// Tags flip a bit in place; the filtered pass visits the untagged half.
+		runner.Measure("add_tag", count / 2, 0, [&]
+		{
+			for (size_t i = 0; i < count; i += 2)
+			{
+				ecsManager.AddComponent<Static>(entities[i]);
+			}
+		});
+
+		runner.Measure("iterate_without_tag", count / 2, sizeof(Position), [&]
+		{
+			ecsManager.View<Position>().Without<Static>().Each([](Entity, Position& position)
+			{
+				position.x += 1.0f;
+			});
+		});
+
+		runner.Measure("destroy", count, 0, [&]
+		{
+			for (size_t index : order)
+			{
+				ecsManager.DestroyEntity(entities[index]);
+			}
+		});
+
+		// Indices now come from the free list and chunks from the pool.
+		entities.clear();
+		runner.Measure("create_recycled", count, 0, [&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				entities.push_back(ecsManager.CreateEntity());
+			}
+		});
+
+		// Same components as create + add_component, stamped from a prefab in one call.
+		ECSManager prefabWorld;
+		Prefab prefab;
+		prefab.Set<Position>();
+		prefab.Set<Velocity>();
+		std::span<const Entity> instances;
+		runner.Measure("instantiate_prefab", count, 0, [&]
+		{
+			instances = prefabWorld.Instantiate(prefab, count);
+		});
+
+		// Again into the indices and chunks the first batch leaves behind.
+		entities.assign(instances.begin(), instances.end());
+		for (Entity entity : entities)
+		{
+			prefabWorld.DestroyEntity(entity);
+		}
+		runner.Measure("instantiate_prefab_recycled", count, 0, [&]
+		{
+			prefabWorld.Instantiate(prefab, count);
+		});
+
+		results.insert(results.end(), runner.results.begin(), runner.results.end());
+	}
+
+	double GigabytesPerSecond(const Result& result)
+	{
+		return result.bytesPerEntity && result.nsPerOp > 0.0 ? static_cast<double>(result.bytesPerEntity) / result.nsPerOp : 0.0;
+	}
+
+	void WriteJson(std::FILE* out, const std::vector<Result>& results)
+	{
+		std::fprintf(out, "{\n  \"benchmark\": \"ecs\",\n  \"entityHandleBytes\": %zu,\n  \"results\": [\n", sizeof(Entity));
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const Result& result = results[i];
+			std::fprintf(out,
+				"    { \"name\": \"%s\", \"entities\": %zu, \"nsPerOp\": %.3f, \"allocationsPerOp\": %.6f, "
+				"\"allocatedBytesPerOp\": %.3f, \"bytesPerEntity\": %zu, \"gigabytesPerSecond\": %.3f }%s\n",
+				result.name.c_str(), result.entities, result.nsPerOp, result.allocationsPerOp,
+				result.allocatedBytesPerOp, result.bytesPerEntity, GigabytesPerSecond(result), i + 1 < results.size() ? "," : "");
+		}
+		std::fprintf(out, "  ]\n}\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	size_t maxEntities = 10000000;
+	const char* jsonPath = nullptr;
+	for (int i = 1; i + 1 < argc; i += 2)
+	{
+		if (std::strcmp(argv[i], "--max") == 0)
+		{
+			maxEntities = std::strtoull(argv[i + 1], nullptr, 10);
+		}
+		else if (std::strcmp(argv[i], "--json") == 0)
+		{
+			jsonPath = argv[i + 1];
+		}
+	}
+
+	std::vector<Result> results;
+	for (size_t count = 1000; count <= maxEntities; count *= 10)
+	{
+		RunSuite(count, results);
+	}
+
+	std::printf("%-10s %-20s %10s %12s %12s %10s\n", "entities", "benchmark", "ns/op", "allocs/op", "bytes/op", "GB/s");
+	for (const Result& result : results)
+	{
+		std::printf("%-10zu %-20s %10.2f %12.4f %12.1f %10.2f\n", result.entities, result.name.c_str(), result.nsPerOp,
+			result.allocationsPerOp, result.allocatedBytesPerOp, GigabytesPerSecond(result));
+	}
+
+	if (jsonPath)
+	{
+		std::FILE* out = std::strcmp(jsonPath, "-") == 0 ? stdout : std::fopen(jsonPath, "w");
+		if (!out)
+		{
+			std::fprintf(stderr, "Failed to open %s\n", jsonPath);
+			return 1;
+		}
+		WriteJson(out, results);
+		if (out != stdout)
+		{
+			std::fclose(out);
+		}
+	}
+	return 0;
+}
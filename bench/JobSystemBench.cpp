@@ -0,0 +1,145 @@
+// Measures task spawn, steal and parallel-for overhead of the job system.
+// Usage: job_bench [workerCount]
+
+#include "../src/engine/core/include/JobSystem.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	std::atomic<uint64_t> sink{ 0 };
+
+	constexpr size_t FanOut = 32;
+
+	template <typename Func>
+	double NsPerOp(size_t count, Func&& func)
+	{
+		auto start = std::chrono::steady_clock::now();
+		func();
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(count);
+	}
+
+	void Report(const char* name, double nsPerOp, const JobSystem& jobs)
+	{
+		JobSystem::Stats stats = jobs.GetStats();
+		double stolenPercent = stats.executed ? 100.0 * static_cast<double>(stats.stolen) / static_cast<double>(stats.executed) : 0.0;
+		std::printf("%-38s %10.1f ns/op   threads %zu   executed %-10llu stolen %5.1f%%\n", name, nsPerOp,
+			jobs.GetThreadCount(), static_cast<unsigned long long>(stats.executed), stolenPercent);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	size_t workerCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : std::max(std::thread::hardware_concurrency(), 1u) - 1;
+	JobSystem jobs(workerCount);
+	std::printf("job system: %zu workers + main thread\n", jobs.GetWorkerCount());
+
+	const size_t jobCount = 1000000;
+
+	// Main thread spawns empty jobs and helps run them while waiting.
+	jobs.ResetStats();
+	Report("spawn+run (main thread)", NsPerOp(jobCount, [&]
+	{
+		JobCounter counter;
+		for (size_t i = 0; i < jobCount; ++i)
+		{
+			jobs.Run([] { sink.fetch_add(1, std::memory_order_relaxed); }, &counter);
+			if ((i & (JobSystem::MaxJobsPerThread / 2 - 1)) == 0)
+			{
+				jobs.RunPendingJob();
+			}
+		}
+		jobs.Wait(counter);
+	}), jobs);
+
+	// Main thread only waits, so every job has to be stolen by a worker.
+	if (jobs.GetWorkerCount() > 0)
+	{
+		jobs.ResetStats();
+		std::atomic<size_t> done{ 0 };
+		Report("steal (main thread spawns only)", NsPerOp(jobCount, [&]
+		{
+			for (size_t i = 0; i < jobCount; ++i)
+			{
+				jobs.Run([&done] { done.fetch_add(1, std::memory_order_relaxed); });
+				while (i + 1 - done.load(std::memory_order_relaxed) >= JobSystem::MaxJobsPerThread / 2)
+				{
+					std::this_thread::yield();
+				}
+			}
+			while (done.load() < jobCount)
+			{
+				std::this_thread::yield();
+			}
+		}), jobs);
+	}
+
+	// Jobs spawning children from worker threads, a fork-join tree of depth 4.
+	jobs.ResetStats();
+	const size_t treeJobs = FanOut + FanOut * FanOut + FanOut * FanOut * FanOut;
+	Report("nested spawn (fan-out 32)", NsPerOp(treeJobs, [&]
+	{
+		JobCounter counter;
+		for (size_t a = 0; a < FanOut; ++a)
+		{
+			jobs.Run([&jobs, &counter]
+			{
+				for (size_t b = 0; b < FanOut; ++b)
+				{
+					jobs.Run([&jobs, &counter]
+					{
+						for (size_t c = 0; c < FanOut; ++c)
+						{
+							jobs.Run([] { sink.fetch_add(1, std::memory_order_relaxed); }, &counter);
+						}
+					}, &counter);
+				}
+			}, &counter);
+		}
+		jobs.Wait(counter);
+	}), jobs);
+
+	// Parallel-for summing an array, automatic and fixed grain sizes. With a single
+	// thread ParallelFor runs inline and executes no jobs.
+	const size_t elements = 16 * 1024 * 1024;
+	std::vector<uint32_t> values(elements);
+	for (size_t i = 0; i < elements; ++i)
+	{
+		values[i] = static_cast<uint32_t>(i * 2654435761u);
+	}
+	for (size_t grain : { size_t(0), size_t(64), size_t(4096) })
+	{
+		jobs.ResetStats();
+		sink.store(0);
+		char name[64];
+		std::snprintf(name, sizeof(name), grain ? "parallel-for grain %zu" : "parallel-for auto grain (%zu ranges)",
+			grain ? grain : jobs.GetThreadCount() * 4);
+		Report(name, NsPerOp(elements, [&]
+		{
+			jobs.ParallelFor(elements, [&values](size_t begin, size_t end)
+			{
+				uint64_t sum = 0;
+				for (size_t i = begin; i < end; ++i)
+				{
+					sum += values[i];
+				}
+				sink.fetch_add(sum, std::memory_order_relaxed);
+			}, grain);
+		}), jobs);
+		uint64_t expected = 0;
+		for (uint32_t value : values)
+		{
+			expected += value;
+		}
+		if (sink.load() != expected)
+		{
+			std::printf("parallel-for sum mismatch\n");
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,219 @@
+// Compares sparse-set component pools against the per-entity hash maps the ECS used to
+// store components in (Entity's typeid-keyed map and ECSManager's dynamic_cast walk).
+
+#include "../src/engine/ecs/include/SparseSet.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	// The old storage deleted and dynamic_cast components through a polymorphic base.
+	struct LegacyComponent
+	{
+		virtual ~LegacyComponent() = default;
+	};
+
+	struct Position : public LegacyComponent
+	{
+		Position(float x, float y, float z) : x(x), y(y), z(z) {}
+		float x, y, z;
+	};
+
+	struct Velocity : public LegacyComponent
+	{
+		Velocity(float x, float y, float z) : x(x), y(y), z(z) {}
+		float x, y, z;
+	};
+
+	struct Results
+	{
+		double add = 0.0;
+		double lookup = 0.0;
+		double iterate = 0.0;
+		double remove = 0.0;
+	};
+
+	volatile float sink;
+
+	template <typename Func>
+	double NsPerOp(size_t count, Func&& func)
+	{
+		auto start = std::chrono::steady_clock::now();
+		func();
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(count);
+	}
+
+	// Entity's former storage: one hash map per entity keyed on typeid(T).hash_code().
+	Results RunEntityMaps(size_t count, const std::vector<Entity::IdType>& order)
+	{
+		Results results;
+		std::vector<std::unordered_map<size_t, std::shared_ptr<LegacyComponent>>> entities(count);
+		const size_t positionKey = typeid(Position).hash_code();
+		const size_t velocityKey = typeid(Velocity).hash_code();
+
+		results.add = NsPerOp(count, [&]
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				entities[i][positionKey] = std::make_shared<Position>(float(i), 0.0f, 0.0f);
+				entities[i][velocityKey] = std::make_shared<Velocity>(1.0f, 0.0f, 0.0f);
+			}
+		});
+		results.lookup = NsPerOp(count, [&]
+		{
+			float sum = 0.0f;
+			for (Entity::IdType id : order)
+			{
+				auto it = entities[id].find(velocityKey);
+				sum += static_cast<Velocity*>(it->second.get())->x;
+			}
+			sink = sum;
+		});
+		results.iterate = NsPerOp(count, [&]
+		{
+			for (auto& components : entities)
+			{
+				auto* position = static_cast<Position*>(components.find(positionKey)->second.get());
+				auto* velocity = static_cast<Velocity*>(components.find(velocityKey)->second.get());
+				position->x += velocity->x;
+			}
+		});
+		results.remove = NsPerOp(count, [&]
+		{
+			for (Entity::IdType id : order)
+			{
+				entities[id].erase(velocityKey);
+			}
+		});
+		return results;
+	}
+
+	// ECSManager's former storage: a component vector per entity, searched with dynamic_cast.
+	Results RunManagerMap(size_t count, const std::vector<Entity::IdType>& order)
+	{
+		Results results;
+		std::unordered_map<Entity::IdType, std::vector<std::shared_ptr<LegacyComponent>>> components;
+
+		auto find = [&](Entity::IdType id, auto* type) -> decltype(type)
+		{
+			for (auto& component : components[id])
+			{
+				if (auto* casted = dynamic_cast<decltype(type)>(component.get()))
+				{
+					return casted;
+				}
+			}
+			return nullptr;
+		};
+
+		results.add = NsPerOp(count, [&]
+		{
+			for (Entity::IdType i = 0; i < count; ++i)
+			{
+				components[i].push_back(std::make_shared<Position>(float(i), 0.0f, 0.0f));
+				components[i].push_back(std::make_shared<Velocity>(1.0f, 0.0f, 0.0f));
+			}
+		});
+		results.lookup = NsPerOp(count, [&]
+		{
+			float sum = 0.0f;
+			for (Entity::IdType id : order)
+			{
+				sum += find(id, static_cast<Velocity*>(nullptr))->x;
+			}
+			sink = sum;
+		});
+		results.iterate = NsPerOp(count, [&]
+		{
+			for (Entity::IdType i = 0; i < count; ++i)
+			{
+				find(i, static_cast<Position*>(nullptr))->x += find(i, static_cast<Velocity*>(nullptr))->x;
+			}
+		});
+		results.remove = NsPerOp(count, [&]
+		{
+			for (Entity::IdType id : order)
+			{
+				auto& list = components[id];
+				list.erase(std::remove_if(list.begin(), list.end(),
+					[](auto& component) { return dynamic_cast<Velocity*>(component.get()) != nullptr; }), list.end());
+			}
+		});
+		return results;
+	}
+
+	Results RunSparseSet(size_t count, const std::vector<Entity::IdType>& order)
+	{
+		Results results;
+		SparseSet<Position> positions;
+		SparseSet<Velocity> velocities;
+
+		results.add = NsPerOp(count, [&]
+		{
+			for (Entity::IdType i = 0; i < count; ++i)
+			{
+				positions.Emplace(Entity(i), float(i), 0.0f, 0.0f);
+				velocities.Emplace(Entity(i), 1.0f, 0.0f, 0.0f);
+			}
+		});
+		results.lookup = NsPerOp(count, [&]
+		{
+			float sum = 0.0f;
+			for (Entity::IdType id : order)
+			{
+				sum += velocities.Find(Entity(id))->x;
+			}
+			sink = sum;
+		});
+		results.iterate = NsPerOp(count, [&]
+		{
+			// Drive from the velocity pool and probe positions, as a two-component join would.
+			const auto& entities = velocities.GetEntities();
+			auto& velocity = velocities.GetComponents();
+			for (size_t i = 0; i < entities.size(); ++i)
+			{
+				positions.Find(entities[i])->x += velocity[i].x;
+			}
+		});
+		results.remove = NsPerOp(count, [&]
+		{
+			for (Entity::IdType id : order)
+			{
+				velocities.Remove(Entity(id));
+			}
+		});
+		return results;
+	}
+
+	void Print(size_t count, const char* backend, const Results& results)
+	{
+		std::printf("%-10zu %-14s %10.2f %10.2f %10.2f %10.2f\n",
+			count, backend, results.add, results.lookup, results.iterate, results.remove);
+	}
+}
+
+int main()
+{
+	std::printf("%-10s %-14s %10s %10s %10s %10s   (ns/op)\n", "entities", "storage", "add", "lookup", "iterate", "remove");
+
+	std::mt19937 rng(1234);
+	for (size_t count : { 10000u, 100000u, 1000000u })
+	{
+		std::vector<Entity::IdType> order(count);
+		std::iota(order.begin(), order.end(), 0u);
+		std::shuffle(order.begin(), order.end(), rng);
+
+		Print(count, "entity-map", RunEntityMaps(count, order));
+		Print(count, "manager-map", RunManagerMap(count, order));
+		Print(count, "sparse-set", RunSparseSet(count, order));
+	}
+	return 0;
+}
@@ -0,0 +1,140 @@
+// Spawn-heavy frame loop: every frame systems record entity creation and destruction
+// through command buffers while others iterate. Counts calls into the global allocator
+// per frame; once the world has reached its steady-state size it should report zero.
+// Usage: spawn_bench [population] [frames]
+
+#include "../src/engine/ecs/include/ECSManager.h"
+#include "AllocationCounter.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+	struct Position : Component
+	{
+		float x = 0.0f, y = 0.0f, z = 0.0f;
+	};
+
+	struct Velocity : Component
+	{
+		float x = 0.0f, y = 0.0f, z = 0.0f;
+	};
+
+	struct Lifetime : Component
+	{
+		uint32_t framesLeft = 0;
+	};
+
+	struct Highlighted : Component
+	{
+		static constexpr ComponentStorage Storage = ComponentStorage::SparseSet;
+		float intensity = 0.0f;
+	};
+
+	// Destroys expired entities and spawns replacements, keeping the population constant.
+	class SpawnSystem : public System
+	{
+	public:
+		explicit SpawnSystem(uint32_t lifetime) : lifetime(lifetime)
+		{
+			Writes<Lifetime>();
+		}
+
+		const char* GetName() const override { return "SpawnSystem"; }
+
+		void Update(float) override
+		{
+			EntityCommandBuffer& commands = ecsManager->GetCommandBuffer();
+			ecsManager->Each<Lifetime>([&](Entity entity, Lifetime& life)
+			{
+				if (life.framesLeft-- > 0)
+				{
+					return;
+				}
+				commands.DestroyEntity(entity);
+
+				Entity spawned = commands.CreateEntity();
+				commands.AddComponent<Position>(spawned);
+				commands.AddComponent<Velocity>(spawned, Velocity{ {}, 1.0f, 0.5f, 0.25f });
+				commands.AddComponent<Lifetime>(spawned, Lifetime{ {}, lifetime });
+				if (++spawnCount % 8 == 0)
+				{
+					commands.AddComponent<Highlighted>(spawned, Highlighted{ {}, 1.0f });
+				}
+			});
+		}
+
+	private:
+		uint32_t lifetime;
+		uint32_t spawnCount = 0;
+	};
+
+	class MoveSystem : public System
+	{
+	public:
+		MoveSystem()
+		{
+			Writes<Position>();
+			Reads<Velocity>();
+		}
+
+		const char* GetName() const override { return "MoveSystem"; }
+
+		void Update(float deltaTime) override
+		{
+			ecsManager->Each<Position, const Velocity>([deltaTime](Entity, Position& position, const Velocity& velocity)
+			{
+				position.x += velocity.x * deltaTime;
+				position.y += velocity.y * deltaTime;
+				position.z += velocity.z * deltaTime;
+			});
+		}
+	};
+}
+
+int main(int argc, char** argv)
+{
+	const size_t population = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+	const size_t frames = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 300;
+	const uint32_t lifetime = 60;
+
+	ECSManager ecsManager;
+	for (size_t i = 0; i < population; ++i)
+	{
+		Entity entity = ecsManager.CreateEntity();
+		ecsManager.AddComponent<Position>(entity);
+		ecsManager.AddComponent<Velocity>(entity, Velocity{ {}, 1.0f, 0.5f, 0.25f });
+		// Stagger lifetimes so a constant slice of the population respawns every frame.
+		ecsManager.AddComponent<Lifetime>(entity, Lifetime{ {}, static_cast<uint32_t>(i % lifetime) });
+	}
+	ecsManager.AddSystem(std::make_shared<SpawnSystem>(lifetime));
+	ecsManager.AddSystem(std::make_shared<MoveSystem>());
+
+	std::printf("population %zu, %zu frames, ~%zu spawns per frame\n", population, frames, population / lifetime);
+	std::printf("%-8s %12s %12s %14s\n", "frames", "ms/frame", "allocs/frame", "bytes/frame");
+
+	// Report in windows so warm-up growth is visible separately from the steady state.
+	const size_t window = std::max<size_t>(frames / 6, 1);
+	for (size_t first = 0; first < frames; first += window)
+	{
+		const size_t count = std::min(window, frames - first);
+		const AllocationCounter::Snapshot before;
+		auto start = std::chrono::steady_clock::now();
+		for (size_t frame = 0; frame < count; ++frame)
+		{
+			ecsManager.UpdateSystems(1.0f / 60.0f);
+		}
+		auto end = std::chrono::steady_clock::now();
+		const double frameCount = static_cast<double>(count);
+		std::printf("%3zu-%-4zu %12.3f %12.1f %14.1f\n", first, first + count - 1,
+			std::chrono::duration<double, std::milli>(end - start).count() / frameCount,
+			static_cast<double>(AllocationCounter::Snapshot().count - before.count) / frameCount,
+			static_cast<double>(AllocationCounter::Snapshot().bytes - before.bytes) / frameCount);
+	}
+
+	std::printf("\n");
+	ecsManager.DumpMemoryStats(std::cout);
+	return 0;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "MemoryTracker.h"
+
+// Where one frame's time went, in milliseconds.
+struct FrameTiming
+{
+	float simulateMilliseconds = 0.0f;
+	float renderMilliseconds = 0.0f;
+	float swapMilliseconds = 0.0f;
+
+	float GetTotal() const { return simulateMilliseconds + renderMilliseconds + swapMilliseconds; }
+};
+
+// Ring of the last frames' timings with statistics kept up to date as frames enter and
+// leave it: a histogram per phase for percentiles, running sums for averages and a count
+// of hitches, frames whose total exceeds the hitch threshold. Querying costs a walk over
+// the histogram, never a sort, so it is cheap enough for an overlay every frame and the
+// same numbers are available headless through WriteJson.
+class FrameTelemetry
+{
+public:
+	enum class Phase
+	{
+		Simulate,
+		Render,
+		Swap,
+		Total
+	};
+	static constexpr size_t PhaseCount = 4;
+
+	// Percentile resolution. Frames slower than BucketCount * BucketMilliseconds share
+	// the last bucket, so percentiles saturate there.
+	static constexpr float BucketMilliseconds = 0.1f;
+	static constexpr size_t BucketCount = 1000;
+
+	explicit FrameTelemetry(size_t capacity = 600, float hitchMilliseconds = 33.3f);
+
+	void Record(const FrameTiming& timing);
+
+	size_t GetCount() const { return count; }
+	size_t GetCapacity() const { return frames.size(); }
+	// Frames in the ring, index 0 being the oldest.
+	const FrameTiming& GetFrame(size_t index) const { return frames[(next + frames.size() - count + index) % frames.size()]; }
+	static float GetValue(const FrameTiming& timing, Phase phase);
+
+	float GetAverage(Phase phase) const;
+	// Upper edge of the bucket holding the given percentile (0-100) of the ring.
+	float GetPercentile(Phase phase, float percentile) const;
+
+	float GetHitchMilliseconds() const { return hitchMilliseconds; }
+	size_t GetHitchCount() const { return hitches; }
+	uint64_t GetTotalHitchCount() const { return totalHitches; }
+	uint64_t GetTotalFrameCount() const { return totalFrames; }
+
+	void WriteJson(std::ostream& out) const;
+	bool Save(const std::string& path) const;
+
+private:
+	static size_t GetBucket(float milliseconds);
+	void Add(const FrameTiming& timing, int sign);
+
+	TrackedVector<FrameTiming, MemoryTag::Core> frames;
+	size_t next = 0;
+	size_t count = 0;
+	std::array<TrackedVector<uint32_t, MemoryTag::Core>, PhaseCount> histograms;
+	std::array<double, PhaseCount> sums{};
+	float hitchMilliseconds;
+	size_t hitches = 0;
+	uint64_t totalHitches = 0;
+	uint64_t totalFrames = 0;
+};
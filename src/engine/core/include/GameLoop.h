@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Fixed-timestep driver. Real time from a steady clock accumulates between frames and is
+// spent in whole simulation steps, so the simulation advances the same way at any frame
+// rate, and rendering draws once per frame between the last two steps using GetAlpha.
+// After a stall at most maxStepsPerFrame steps run and the rest of the owed time is
+// dropped, so the simulation slows down rather than falling further and further behind.
+class GameLoop
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	explicit GameLoop(double stepSeconds = 1.0 / 60.0, uint32_t maxStepsPerFrame = 8);
+
+	// Adds the real time since the previous call and runs step(GetStepSeconds()) once for
+	// each whole step owed. Returns the number of steps run, which may be zero.
+	template <typename Step>
+	uint32_t Advance(Step&& step)
+	{
+		return AdvanceBy(Sample(), step);
+	}
+
+	// Same with the elapsed time given, for replays and headless runs.
+	template <typename Step>
+	uint32_t AdvanceBy(Clock::duration elapsed, Step&& step)
+	{
+		const uint32_t steps = Accumulate(elapsed);
+		for (uint32_t i = 0; i < steps; ++i)
+		{
+			step(stepSeconds);
+			++stepCount;
+		}
+		return steps;
+	}
+
+	// How far the time left over lies towards the next step, in [0, 1). Render the
+	// previous step's state blended this far towards the current one.
+	float GetAlpha() const;
+
+	float GetStepSeconds() const { return stepSeconds; }
+	// Steps run so far, usable as the simulation tick.
+	uint64_t GetStepCount() const { return stepCount; }
+	// Time passed to the last Advance.
+	double GetFrameSeconds() const;
+	// Owed time discarded by the catch-up cap so far.
+	double GetDroppedSeconds() const;
+
+	// Restarts the clock without owing any time, e.g. after loading or a long pause.
+	void Reset();
+
+private:
+	Clock::duration Sample();
+	uint32_t Accumulate(Clock::duration elapsed);
+
+	Clock::duration step;
+	float stepSeconds;
+	uint32_t maxSteps;
+	Clock::time_point last;
+	Clock::duration accumulator{ 0 };
+	Clock::duration frameTime{ 0 };
+	Clock::duration dropped{ 0 };
+	uint64_t stepCount = 0;
+};
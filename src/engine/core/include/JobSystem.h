@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Number of unfinished jobs in a batch. Jobs decrement it when they complete; pass it to
+// JobSystem::Wait to join the batch.
+class JobCounter
+{
+public:
+	bool IsDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class JobSystem;
+	std::atomic<uint32_t> pending{ 0 };
+};
+
+// Work-stealing task system. Every worker, plus the thread that created the system,
+// owns a lock-free deque: it pushes and pops its own jobs at the bottom while idle
+// threads steal from the top. Threads that wait on a counter run jobs meanwhile.
+class JobSystem
+{
+public:
+	static constexpr size_t MaxJobsPerThread = 4096;
+
+	struct Stats
+	{
+		uint64_t executed = 0;
+		uint64_t stolen = 0;
+	};
+
+	explicit JobSystem(size_t workerCount = std::max(std::thread::hardware_concurrency(), 1u) - 1);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Queues func() to run on any thread. Captures must fit in Job::StorageSize bytes;
+	// pass larger state by reference or pointer.
+	template <typename Func>
+	void Run(Func&& func, JobCounter* counter = nullptr);
+
+	// Runs pending jobs on the calling thread until counter reaches zero.
+	void Wait(JobCounter& counter);
+
+	// Runs a single pending job on the calling thread. Returns false if none was found.
+	bool RunPendingJob();
+
+	// Calls func(begin, end) over sub-ranges of [0, count) and returns once all are done.
+	// A grainSize of zero splits the range into a few pieces per thread.
+	template <typename Func>
+	void ParallelFor(size_t count, Func&& func, size_t grainSize = 0);
+
+	size_t GetWorkerCount() const { return workers.size(); }
+	size_t GetThreadCount() const { return threads.size(); }
+
+	// 0 for the creating thread, 1..N for workers, -1 for any other thread. Several job
+	// systems can share a creating thread; each gives it index 0 in its own queues.
+	int GetThreadIndex() const;
+
+	Stats GetStats() const;
+	void ResetStats();
+
+private:
+	struct alignas(64) Job
+	{
+		static constexpr size_t StorageSize = 96;
+
+		alignas(16) unsigned char storage[StorageSize];
+		void (*invoke)(Job& job) = nullptr;
+		void (*destroy)(Job& job) = nullptr;
+		JobCounter* counter = nullptr;
+		std::atomic<bool> active{ false };
+		bool heapAllocated = false;
+	};
+
+	// Chase-Lev deque with a fixed power-of-two capacity.
+	class WorkQueue
+	{
+	public:
+		static constexpr int64_t Capacity = MaxJobsPerThread;
+
+		bool Push(Job* job);
+		Job* Pop();
+		Job* Steal();
+
+	private:
+		alignas(64) std::atomic<int64_t> top{ 0 };
+		alignas(64) std::atomic<int64_t> bottom{ 0 };
+		std::unique_ptr<std::atomic<Job*>[]> buffer{ new std::atomic<Job*>[Capacity] };
+	};
+
+	struct ThreadState
+	{
+		WorkQueue queue;
+		std::unique_ptr<Job[]> jobs{ new Job[MaxJobsPerThread] };
+		size_t nextJob = 0;
+		std::atomic<uint64_t> executed{ 0 };
+		std::atomic<uint64_t> stolen{ 0 };
+	};
+
+	Job* AllocateJob();
+	void Submit(Job* job);
+	Job* FindJob(int threadIndex);
+	void Execute(Job* job, int threadIndex);
+	void WorkerLoop(int threadIndex);
+
+	std::vector<std::unique_ptr<ThreadState>> threads;
+	std::vector<std::thread> workers;
+	std::thread::id ownerThread;
+
+	std::mutex injectedMutex;
+	std::deque<Job*> injected;
+	std::atomic<size_t> injectedCount{ 0 };
+
+	std::atomic<bool> stopping{ false };
+	std::atomic<int64_t> queuedJobs{ 0 };
+	std::atomic<uint32_t> sleepers{ 0 };
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+};
+
+template <typename Func>
+void JobSystem::Run(Func&& func, JobCounter* counter)
+{
+	using Callable = std::decay_t<Func>;
+	static_assert(sizeof(Callable) <= Job::StorageSize, "job capture too large; capture by reference instead");
+	static_assert(alignof(Callable) <= 16, "job capture over-aligned");
+
+	Job* job = AllocateJob();
+	new (job->storage) Callable(std::forward<Func>(func));
+	job->invoke = [](Job& job) { (*std::launder(reinterpret_cast<Callable*>(job.storage)))(); };
+	job->destroy = [](Job& job) { std::launder(reinterpret_cast<Callable*>(job.storage))->~Callable(); };
+	job->counter = counter;
+	if (counter)
+	{
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+	}
+	Submit(job);
+}
+
+template <typename Func>
+void JobSystem::ParallelFor(size_t count, Func&& func, size_t grainSize)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	if (grainSize == 0)
+	{
+		size_t pieces = threads.size() * 4;
+		grainSize = std::max<size_t>((count + pieces - 1) / pieces, 1);
+	}
+	if (count <= grainSize || threads.size() == 1)
+	{
+		func(size_t(0), count);
+		return;
+	}
+
+	// Queue all but the first range and run that one here.
+	JobCounter counter;
+	for (size_t begin = grainSize; begin < count; begin += grainSize)
+	{
+		size_t end = std::min(begin + grainSize, count);
+		Run([&func, begin, end] { func(begin, end); }, &counter);
+	}
+	func(size_t(0), grainSize);
+	Wait(counter);
+}
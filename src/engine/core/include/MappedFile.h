@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. The OS pages data in on first touch, so
+// opening is cheap regardless of file size.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const std::string& path);
+	void Close();
+
+	const std::byte* GetData() const { return data; }
+	size_t GetSize() const { return size; }
+
+private:
+	const std::byte* data = nullptr;
+	size_t size = 0;
+#ifdef _WIN32
+	void* file = nullptr;
+	void* mapping = nullptr;
+#endif
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define ENGINE_MATH_SSE 1
+#include <xmmintrin.h>
+#endif
+
+struct Vec3
+{
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+};
+
+// Unit quaternion; the default is the identity rotation.
+struct Quat
+{
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+	float w = 1.0f;
+
+	static Quat FromAxisAngle(const Vec3& axis, float radians)
+	{
+		float length = std::sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+		float s = length > 0.0f ? std::sin(radians * 0.5f) / length : 0.0f;
+		return { axis.x * s, axis.y * s, axis.z * s, std::cos(radians * 0.5f) };
+	}
+};
+
+// Column-major 4x4 matrix, matching OpenGL's layout. Columns are 16-byte aligned so
+// products run four lanes at a time where SSE is available.
+struct alignas(16) Mat4
+{
+	float m[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+	float* Column(int column) { return m + column * 4; }
+	const float* Column(int column) const { return m + column * 4; }
+
+	Vec3 GetTranslation() const { return { m[12], m[13], m[14] }; }
+
+	// Scale, then rotate, then translate.
+	static Mat4 FromTRS(const Vec3& translation, const Quat& rotation, const Vec3& scale)
+	{
+		const float x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+		const float xx = x * x, yy = y * y, zz = z * z;
+		const float xy = x * y, xz = x * z, yz = y * z;
+		const float wx = w * x, wy = w * y, wz = w * z;
+
+		Mat4 result;
+		float* r = result.m;
+		r[0] = (1.0f - 2.0f * (yy + zz)) * scale.x;
+		r[1] = 2.0f * (xy + wz) * scale.x;
+		r[2] = 2.0f * (xz - wy) * scale.x;
+		r[3] = 0.0f;
+		r[4] = 2.0f * (xy - wz) * scale.y;
+		r[5] = (1.0f - 2.0f * (xx + zz)) * scale.y;
+		r[6] = 2.0f * (yz + wx) * scale.y;
+		r[7] = 0.0f;
+		r[8] = 2.0f * (xz + wy) * scale.z;
+		r[9] = 2.0f * (yz - wx) * scale.z;
+		r[10] = (1.0f - 2.0f * (xx + yy)) * scale.z;
+		r[11] = 0.0f;
+		r[12] = translation.x;
+		r[13] = translation.y;
+		r[14] = translation.z;
+		r[15] = 1.0f;
+		return result;
+	}
+};
+
+// Element-wise blend from a (t = 0) to b (t = 1). Close enough to a proper decomposition
+// for the small change between two simulation steps.
+inline Mat4 Lerp(const Mat4& a, const Mat4& b, float t)
+{
+	Mat4 result;
+	for (int i = 0; i < 16; ++i)
+	{
+		result.m[i] = a.m[i] + (b.m[i] - a.m[i]) * t;
+	}
+	return result;
+}
+
+inline Mat4 operator*(const Mat4& a, const Mat4& b)
+{
+	Mat4 result;
+#if defined(ENGINE_MATH_SSE)
+	// Each result column is a linear combination of a's columns weighted by b's column.
+	const __m128 a0 = _mm_load_ps(a.Column(0));
+	const __m128 a1 = _mm_load_ps(a.Column(1));
+	const __m128 a2 = _mm_load_ps(a.Column(2));
+	const __m128 a3 = _mm_load_ps(a.Column(3));
+	for (int column = 0; column < 4; ++column)
+	{
+		const float* weights = b.Column(column);
+		__m128 sum = _mm_mul_ps(a0, _mm_set1_ps(weights[0]));
+		sum = _mm_add_ps(sum, _mm_mul_ps(a1, _mm_set1_ps(weights[1])));
+		sum = _mm_add_ps(sum, _mm_mul_ps(a2, _mm_set1_ps(weights[2])));
+		sum = _mm_add_ps(sum, _mm_mul_ps(a3, _mm_set1_ps(weights[3])));
+		_mm_store_ps(result.Column(column), sum);
+	}
+#else
+	for (int column = 0; column < 4; ++column)
+	{
+		for (int row = 0; row < 4; ++row)
+		{
+			float sum = 0.0f;
+			for (int k = 0; k < 4; ++k)
+			{
+				sum += a.m[k * 4 + row] * b.m[column * 4 + k];
+			}
+			result.m[column * 4 + row] = sum;
+		}
+	}
+#endif
+	return result;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Subsystem an allocation is charged to.
+enum class MemoryTag : uint8_t
+{
+	Core,
+	ECS,
+	Renderer,
+	Assets,
+	Count
+};
+
+struct MemoryTagStats
+{
+	size_t liveBytes = 0;
+	size_t peakBytes = 0;
+	uint64_t allocations = 0;
+	uint64_t frees = 0;
+	// Zero when no budget is set.
+	size_t budget = 0;
+};
+
+// Heap layer that charges allocations to a subsystem tag. Counters are relaxed atomics,
+// so tracked allocations cost a few uncontended increments on top of operator new.
+// Containers opt in through TrackedAllocator; the global operator new is left alone.
+//
+// A tag going over its budget prints one warning, and warns again only after dropping
+// back under it. With callstack sampling on, every Nth tracked allocation records its
+// call stack, printed by Dump.
+class MemoryTracker
+{
+public:
+	// Call stacks kept for Dump; older samples are overwritten.
+	static constexpr size_t MaxSamples = 256;
+	static constexpr size_t MaxSampleFrames = 16;
+
+	static void* Allocate(size_t size, size_t alignment, MemoryTag tag);
+	// size, alignment and tag must match the Allocate call.
+	static void Free(void* memory, size_t size, size_t alignment, MemoryTag tag);
+
+	static MemoryTagStats GetStats(MemoryTag tag);
+	static const char* GetName(MemoryTag tag);
+	static void SetBudget(MemoryTag tag, size_t bytes);
+
+	// Samples one in everyN tracked allocations; 0 turns sampling off. Stacks are only
+	// captured where the platform provides a backtrace.
+	static void SetCallstackSampling(uint32_t everyN);
+
+	// Per-tag table followed by the sampled call stacks, largest first.
+	static void Dump(std::ostream& out);
+
+	// Tracked allocations made by the calling thread so far.
+	static uint64_t GetThreadAllocationCount();
+};
+
+// std allocator charging everything it allocates to Tag.
+template <typename T, MemoryTag Tag>
+class TrackedAllocator
+{
+public:
+	using value_type = T;
+
+	template <typename U>
+	struct rebind
+	{
+		using other = TrackedAllocator<U, Tag>;
+	};
+
+	TrackedAllocator() noexcept = default;
+	template <typename U>
+	TrackedAllocator(const TrackedAllocator<U, Tag>&) noexcept {}
+
+	T* allocate(size_t count) { return static_cast<T*>(MemoryTracker::Allocate(count * sizeof(T), alignof(T), Tag)); }
+	void deallocate(T* memory, size_t count) noexcept { MemoryTracker::Free(memory, count * sizeof(T), alignof(T), Tag); }
+
+	template <typename U>
+	bool operator==(const TrackedAllocator<U, Tag>&) const noexcept { return true; }
+};
+
+template <typename T, MemoryTag Tag>
+using TrackedVector = std::vector<T, TrackedAllocator<T, Tag>>;
+
+template <typename Key, typename Value, MemoryTag Tag, typename Hash = std::hash<Key>>
+using TrackedUnorderedMap = std::unordered_map<Key, Value, Hash, std::equal_to<Key>, TrackedAllocator<std::pair<const Key, Value>, Tag>>;
+
+template <typename T>
+using EcsVector = TrackedVector<T, MemoryTag::ECS>;
+
+template <typename Key, typename Value>
+using EcsUnorderedMap = TrackedUnorderedMap<Key, Value, MemoryTag::ECS>;
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+#include "JobSystem.h"
+
+// One T per JobSystem thread, each on its own cache line, for scratch buffers and partial
+// results that parallel jobs update without locking. Merge the slots afterwards in index
+// order; which thread ran which job varies between runs, so use ComponentView's
+// ParallelReduce where the result has to be reproducible.
+template <typename T>
+class PerThread
+{
+public:
+	explicit PerThread(const JobSystem& jobs, const T& initial = T())
+		: jobs(&jobs), slots(jobs.GetThreadCount(), Slot{ initial })
+	{
+	}
+
+	// Slot of the calling thread, which must belong to the job system.
+	T& Local()
+	{
+		int index = jobs->GetThreadIndex();
+		assert(index >= 0 && "PerThread used from a thread outside its job system");
+		return slots[index].value;
+	}
+
+	size_t Size() const { return slots.size(); }
+	T& operator[](size_t index) { return slots[index].value; }
+	const T& operator[](size_t index) const { return slots[index].value; }
+
+private:
+	struct alignas(64) Slot
+	{
+		T value;
+	};
+
+	const JobSystem* jobs;
+	std::vector<Slot> slots;
+};
@@ -0,0 +1,122 @@
+#include "../include/FrameTelemetry.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+FrameTelemetry::FrameTelemetry(size_t capacity, float hitchMilliseconds)
+	: frames(std::max<size_t>(capacity, 1)), hitchMilliseconds(hitchMilliseconds)
+{
+	for (auto& histogram : histograms)
+	{
+		histogram.assign(BucketCount, 0);
+	}
+}
+
+float FrameTelemetry::GetValue(const FrameTiming& timing, Phase phase)
+{
+	switch (phase)
+	{
+	case Phase::Simulate:
+		return timing.simulateMilliseconds;
+	case Phase::Render:
+		return timing.renderMilliseconds;
+	case Phase::Swap:
+		return timing.swapMilliseconds;
+	default:
+		return timing.GetTotal();
+	}
+}
+
+size_t FrameTelemetry::GetBucket(float milliseconds)
+{
+	const float bucket = std::max(milliseconds, 0.0f) / BucketMilliseconds;
+	return bucket < BucketCount - 1 ? static_cast<size_t>(bucket) : BucketCount - 1;
+}
+
+void FrameTelemetry::Add(const FrameTiming& timing, int sign)
+{
+	for (size_t phase = 0; phase < PhaseCount; ++phase)
+	{
+		const float value = GetValue(timing, static_cast<Phase>(phase));
+		histograms[phase][GetBucket(value)] += sign;
+		sums[phase] += sign * static_cast<double>(value);
+	}
+	if (timing.GetTotal() > hitchMilliseconds)
+	{
+		hitches += sign;
+	}
+}
+
+void FrameTelemetry::Record(const FrameTiming& timing)
+{
+	if (count == frames.size())
+	{
+		Add(frames[next], -1);
+	}
+	else
+	{
+		++count;
+	}
+	frames[next] = timing;
+	next = (next + 1) % frames.size();
+	Add(timing, 1);
+
+	++totalFrames;
+	if (timing.GetTotal() > hitchMilliseconds)
+	{
+		++totalHitches;
+	}
+}
+
+float FrameTelemetry::GetAverage(Phase phase) const
+{
+	return count ? static_cast<float>(sums[static_cast<size_t>(phase)] / count) : 0.0f;
+}
+
+float FrameTelemetry::GetPercentile(Phase phase, float percentile) const
+{
+	if (count == 0)
+	{
+		return 0.0f;
+	}
+	const size_t rank = std::clamp<size_t>(static_cast<size_t>(std::ceil(percentile / 100.0f * count)), 1, count);
+	const auto& histogram = histograms[static_cast<size_t>(phase)];
+	size_t seen = 0;
+	for (size_t bucket = 0; bucket < BucketCount; ++bucket)
+	{
+		seen += histogram[bucket];
+		if (seen >= rank)
+		{
+			return (bucket + 1) * BucketMilliseconds;
+		}
+	}
+	return BucketCount * BucketMilliseconds;
+}
+
+void FrameTelemetry::WriteJson(std::ostream& out) const
+{
+	static const char* names[PhaseCount] = { "simulate", "render", "swap", "total" };
+	out << "{\n  \"frames\": " << count << ",\n  \"totalFrames\": " << totalFrames << ",\n  \"hitchMs\": " << hitchMilliseconds
+		<< ",\n  \"hitches\": " << hitches << ",\n  \"totalHitches\": " << totalHitches << ",\n  \"phases\": {\n";
+	for (size_t phase = 0; phase < PhaseCount; ++phase)
+	{
+		const Phase id = static_cast<Phase>(phase);
+		out << "    \"" << names[phase] << "\": { \"avgMs\": " << GetAverage(id) << ", \"p50Ms\": " << GetPercentile(id, 50.0f)
+			<< ", \"p95Ms\": " << GetPercentile(id, 95.0f) << ", \"p99Ms\": " << GetPercentile(id, 99.0f) << " }"
+			<< (phase + 1 < PhaseCount ? "," : "") << "\n";
+	}
+	out << "  }\n}\n";
+}
+
+bool FrameTelemetry::Save(const std::string& path) const
+{
+	std::ofstream out(path);
+	if (!out)
+	{
+		std::cerr << "Failed to open " << path << " for frame telemetry" << std::endl;
+		return false;
+	}
+	WriteJson(out);
+	return true;
+}
@@ -0,0 +1,56 @@
+#include "../include/GameLoop.h"
+#include <algorithm>
+#include <cassert>
+
+GameLoop::GameLoop(double stepSeconds, uint32_t maxStepsPerFrame)
+	: step(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(stepSeconds))),
+	  stepSeconds(static_cast<float>(stepSeconds)),
+	  maxSteps(std::max(maxStepsPerFrame, 1u)),
+	  last(Clock::now())
+{
+	assert(step.count() > 0 && "GameLoop step must be positive");
+}
+
+float GameLoop::GetAlpha() const
+{
+	return static_cast<float>(static_cast<double>(accumulator.count()) / static_cast<double>(step.count()));
+}
+
+double GameLoop::GetFrameSeconds() const
+{
+	return std::chrono::duration<double>(frameTime).count();
+}
+
+double GameLoop::GetDroppedSeconds() const
+{
+	return std::chrono::duration<double>(dropped).count();
+}
+
+void GameLoop::Reset()
+{
+	last = Clock::now();
+	accumulator = Clock::duration(0);
+}
+
+GameLoop::Clock::duration GameLoop::Sample()
+{
+	Clock::time_point now = Clock::now();
+	Clock::duration elapsed = now - last;
+	last = now;
+	return elapsed;
+}
+
+uint32_t GameLoop::Accumulate(Clock::duration elapsed)
+{
+	frameTime = elapsed;
+	// Whole clock ticks, so no rounding error builds up however long the game runs.
+	accumulator += std::max(elapsed, Clock::duration(0));
+	auto owed = accumulator / step;
+	accumulator -= owed * step;
+	if (owed > maxSteps)
+	{
+		dropped += (owed - maxSteps) * step;
+		owed = maxSteps;
+	}
+	return static_cast<uint32_t>(owed);
+}
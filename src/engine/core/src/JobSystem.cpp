@@ -0,0 +1,298 @@
+#include "../include/JobSystem.h"
+#include "../include/Profiler.h"
+#include <string>
+
+namespace
+{
+	// Set on worker threads only; a worker belongs to one system for its whole life.
+	thread_local const JobSystem* workerSystem = nullptr;
+	thread_local int workerIndex = -1;
+}
+
+bool JobSystem::WorkQueue::Push(Job* job)
+{
+	int64_t b = bottom.load(std::memory_order_relaxed);
+	int64_t t = top.load(std::memory_order_acquire);
+	if (b - t >= Capacity)
+	{
+		return false;
+	}
+	buffer[b & (Capacity - 1)].store(job, std::memory_order_relaxed);
+	bottom.store(b + 1, std::memory_order_release);
+	return true;
+}
+
+JobSystem::Job* JobSystem::WorkQueue::Pop()
+{
+	int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t t = top.load(std::memory_order_relaxed);
+	if (t > b)
+	{
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = buffer[b & (Capacity - 1)].load(std::memory_order_relaxed);
+	if (t == b)
+	{
+		// Last job: race thieves for it.
+		if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			job = nullptr;
+		}
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+JobSystem::Job* JobSystem::WorkQueue::Steal()
+{
+	int64_t t = top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t b = bottom.load(std::memory_order_acquire);
+	if (t >= b)
+	{
+		return nullptr;
+	}
+
+	Job* job = buffer[t & (Capacity - 1)].load(std::memory_order_relaxed);
+	if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		return nullptr;
+	}
+	return job;
+}
+
+JobSystem::JobSystem(size_t workerCount)
+	: ownerThread(std::this_thread::get_id())
+{
+	for (size_t i = 0; i <= workerCount; ++i)
+	{
+		threads.push_back(std::make_unique<ThreadState>());
+	}
+
+	for (size_t i = 1; i <= workerCount; ++i)
+	{
+		workers.emplace_back([this, i] { WorkerLoop(static_cast<int>(i)); });
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping.store(true);
+	}
+	wake.notify_all();
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+
+	// Drain whatever is left so captured state is destroyed.
+	while (RunPendingJob())
+	{
+	}
+}
+
+int JobSystem::GetThreadIndex() const
+{
+	if (workerSystem == this)
+	{
+		return workerIndex;
+	}
+	return std::this_thread::get_id() == ownerThread ? 0 : -1;
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	while (!counter.IsDone())
+	{
+		if (!RunPendingJob())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+bool JobSystem::RunPendingJob()
+{
+	int threadIndex = GetThreadIndex();
+	Job* job = FindJob(threadIndex);
+	if (!job)
+	{
+		return false;
+	}
+	Execute(job, threadIndex);
+	return true;
+}
+
+JobSystem::Stats JobSystem::GetStats() const
+{
+	Stats stats;
+	for (auto& thread : threads)
+	{
+		stats.executed += thread->executed.load(std::memory_order_relaxed);
+		stats.stolen += thread->stolen.load(std::memory_order_relaxed);
+	}
+	return stats;
+}
+
+void JobSystem::ResetStats()
+{
+	for (auto& thread : threads)
+	{
+		thread->executed.store(0, std::memory_order_relaxed);
+		thread->stolen.store(0, std::memory_order_relaxed);
+	}
+}
+
+JobSystem::Job* JobSystem::AllocateJob()
+{
+	// Jobs come from a per-thread ring, handed out in order, so the next slot is the
+	// oldest one and is normally free. If it is still queued or running, use the heap
+	// rather than run other jobs here: Run must not re-enter unrelated work on the
+	// caller's stack.
+	int threadIndex = GetThreadIndex();
+	if (threadIndex >= 0)
+	{
+		ThreadState& state = *threads[threadIndex];
+		Job* job = &state.jobs[state.nextJob++ & (MaxJobsPerThread - 1)];
+		if (!job->active.load(std::memory_order_acquire))
+		{
+			job->active.store(true, std::memory_order_relaxed);
+			return job;
+		}
+	}
+
+	Job* job = new Job();
+	job->heapAllocated = true;
+	job->active.store(true, std::memory_order_relaxed);
+	return job;
+}
+
+void JobSystem::Submit(Job* job)
+{
+	int threadIndex = GetThreadIndex();
+	if (threadIndex >= 0)
+	{
+		if (!threads[threadIndex]->queue.Push(job))
+		{
+			Execute(job, threadIndex);
+			return;
+		}
+	}
+	else
+	{
+		std::lock_guard<std::mutex> lock(injectedMutex);
+		injected.push_back(job);
+		injectedCount.fetch_add(1);
+	}
+
+	queuedJobs.fetch_add(1);
+	if (sleepers.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		wake.notify_one();
+	}
+}
+
+JobSystem::Job* JobSystem::FindJob(int threadIndex)
+{
+	Job* job = nullptr;
+	if (threadIndex >= 0)
+	{
+		job = threads[threadIndex]->queue.Pop();
+	}
+
+	if (!job && injectedCount.load(std::memory_order_relaxed) > 0)
+	{
+		std::lock_guard<std::mutex> lock(injectedMutex);
+		if (!injected.empty())
+		{
+			job = injected.front();
+			injected.pop_front();
+			injectedCount.fetch_sub(1);
+		}
+	}
+
+	if (!job)
+	{
+		size_t count = threads.size();
+		size_t start = threadIndex >= 0 ? static_cast<size_t>(threadIndex) + 1 : 0;
+		for (size_t i = 0; i < count && !job; ++i)
+		{
+			size_t victim = (start + i) % count;
+			if (static_cast<int>(victim) == threadIndex)
+			{
+				continue;
+			}
+			job = threads[victim]->queue.Steal();
+			if (job && threadIndex >= 0)
+			{
+				threads[threadIndex]->stolen.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	if (job)
+	{
+		queuedJobs.fetch_sub(1);
+	}
+	return job;
+}
+
+void JobSystem::Execute(Job* job, int threadIndex)
+{
+	job->invoke(*job);
+	job->destroy(*job);
+	if (threadIndex >= 0)
+	{
+		threads[threadIndex]->executed.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	JobCounter* counter = job->counter;
+	if (job->heapAllocated)
+	{
+		delete job;
+	}
+	else
+	{
+		job->active.store(false, std::memory_order_release);
+	}
+	if (counter)
+	{
+		counter->pending.fetch_sub(1, std::memory_order_release);
+	}
+}
+
+void JobSystem::WorkerLoop(int threadIndex)
+{
+	workerSystem = this;
+	workerIndex = threadIndex;
+	Profiler::SetThreadName("Worker " + std::to_string(threadIndex));
+
+	int idleSpins = 0;
+	while (!stopping.load(std::memory_order_relaxed))
+	{
+		if (Job* job = FindJob(threadIndex))
+		{
+			Execute(job, threadIndex);
+			idleSpins = 0;
+			continue;
+		}
+		if (++idleSpins < 64)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		sleepers.fetch_add(1);
+		wake.wait(lock, [this] { return stopping.load() || queuedJobs.load() > 0; });
+		sleepers.fetch_sub(1);
+		idleSpins = 0;
+	}
+}
@@ -0,0 +1,111 @@
+#include "../include/MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path)
+{
+	Close();
+	file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		file = nullptr;
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		Close();
+		return false;
+	}
+	data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!data)
+	{
+		Close();
+		return false;
+	}
+	size = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data)
+	{
+		UnmapViewOfFile(data);
+	}
+	if (mapping)
+	{
+		CloseHandle(mapping);
+	}
+	if (file)
+	{
+		CloseHandle(file);
+	}
+	data = nullptr;
+	size = 0;
+	mapping = nullptr;
+	file = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path)
+{
+	Close();
+	int descriptor = open(path.c_str(), O_RDONLY);
+	if (descriptor < 0)
+	{
+		return false;
+	}
+	struct stat status;
+	if (fstat(descriptor, &status) != 0 || status.st_size == 0)
+	{
+		close(descriptor);
+		return false;
+	}
+	void* mapped = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+	// The mapping keeps its own reference to the file.
+	close(descriptor);
+	if (mapped == MAP_FAILED)
+	{
+		return false;
+	}
+	data = static_cast<const std::byte*>(mapped);
+	size = static_cast<size_t>(status.st_size);
+	madvise(mapped, size, MADV_SEQUENTIAL);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (data)
+	{
+		munmap(const_cast<std::byte*>(data), size);
+	}
+	data = nullptr;
+	size = 0;
+}
+
+#endif
@@ -0,0 +1,224 @@
+#include "../include/MemoryTracker.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <new>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <execinfo.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace
+{
+	struct alignas(64) TagCounters
+	{
+		std::atomic<size_t> liveBytes{ 0 };
+		std::atomic<size_t> peakBytes{ 0 };
+		std::atomic<uint64_t> allocations{ 0 };
+		std::atomic<uint64_t> frees{ 0 };
+		std::atomic<size_t> budget{ 0 };
+		std::atomic<bool> overBudget{ false };
+	};
+
+	struct Sample
+	{
+		MemoryTag tag = MemoryTag::Core;
+		size_t size = 0;
+		uint32_t frameCount = 0;
+		std::array<void*, MemoryTracker::MaxSampleFrames> frames{};
+	};
+
+	struct SampleRing
+	{
+		std::mutex mutex;
+		std::array<Sample, MemoryTracker::MaxSamples> samples;
+		size_t next = 0;
+		size_t count = 0;
+	};
+
+	std::array<TagCounters, static_cast<size_t>(MemoryTag::Count)> counters;
+	std::atomic<uint32_t> sampleEvery{ 0 };
+	std::atomic<uint64_t> sampleCounter{ 0 };
+	thread_local uint64_t threadAllocations = 0;
+
+	TagCounters& CountersOf(MemoryTag tag)
+	{
+		return counters[static_cast<size_t>(tag)];
+	}
+
+	SampleRing& Samples()
+	{
+		static SampleRing ring;
+		return ring;
+	}
+
+	void RecordSample(MemoryTag tag, size_t size)
+	{
+		Sample sample;
+		sample.tag = tag;
+		sample.size = size;
+#if defined(__linux__) || defined(__APPLE__)
+		sample.frameCount = static_cast<uint32_t>(std::max(0, backtrace(sample.frames.data(), static_cast<int>(sample.frames.size()))));
+#elif defined(_WIN32)
+		sample.frameCount = RtlCaptureStackBackTrace(0, static_cast<DWORD>(sample.frames.size()), sample.frames.data(), nullptr);
+#endif
+
+		SampleRing& ring = Samples();
+		std::lock_guard<std::mutex> lock(ring.mutex);
+		ring.samples[ring.next] = sample;
+		ring.next = (ring.next + 1) % ring.samples.size();
+		ring.count = std::min(ring.count + 1, ring.samples.size());
+	}
+
+	// Aligned and plain operator new must be paired with the matching delete.
+	bool NeedsAlignedNew(size_t alignment)
+	{
+		return alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+	}
+}
+
+void* MemoryTracker::Allocate(size_t size, size_t alignment, MemoryTag tag)
+{
+	void* memory = NeedsAlignedNew(alignment) ? ::operator new(size, std::align_val_t(alignment)) : ::operator new(size);
+
+	TagCounters& tagCounters = CountersOf(tag);
+	tagCounters.allocations.fetch_add(1, std::memory_order_relaxed);
+	const size_t live = tagCounters.liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+	size_t peak = tagCounters.peakBytes.load(std::memory_order_relaxed);
+	while (live > peak && !tagCounters.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+	{
+	}
+
+	const size_t budget = tagCounters.budget.load(std::memory_order_relaxed);
+	if (budget != 0 && live > budget && !tagCounters.overBudget.exchange(true, std::memory_order_relaxed))
+	{
+		std::cerr << "Memory budget exceeded for " << GetName(tag) << ": " << live << " of " << budget << " bytes" << std::endl;
+	}
+
+	++threadAllocations;
+	const uint32_t every = sampleEvery.load(std::memory_order_relaxed);
+	if (every != 0 && sampleCounter.fetch_add(1, std::memory_order_relaxed) % every == 0)
+	{
+		RecordSample(tag, size);
+	}
+	return memory;
+}
+
+void MemoryTracker::Free(void* memory, size_t size, size_t alignment, MemoryTag tag)
+{
+	if (!memory)
+	{
+		return;
+	}
+
+	TagCounters& tagCounters = CountersOf(tag);
+	tagCounters.frees.fetch_add(1, std::memory_order_relaxed);
+	const size_t live = tagCounters.liveBytes.fetch_sub(size, std::memory_order_relaxed) - size;
+	if (live <= tagCounters.budget.load(std::memory_order_relaxed))
+	{
+		tagCounters.overBudget.store(false, std::memory_order_relaxed);
+	}
+
+	if (NeedsAlignedNew(alignment))
+	{
+		::operator delete(memory, size, std::align_val_t(alignment));
+	}
+	else
+	{
+		::operator delete(memory, size);
+	}
+}
+
+MemoryTagStats MemoryTracker::GetStats(MemoryTag tag)
+{
+	const TagCounters& tagCounters = CountersOf(tag);
+	MemoryTagStats stats;
+	stats.liveBytes = tagCounters.liveBytes.load(std::memory_order_relaxed);
+	stats.peakBytes = tagCounters.peakBytes.load(std::memory_order_relaxed);
+	stats.allocations = tagCounters.allocations.load(std::memory_order_relaxed);
+	stats.frees = tagCounters.frees.load(std::memory_order_relaxed);
+	stats.budget = tagCounters.budget.load(std::memory_order_relaxed);
+	return stats;
+}
+
+const char* MemoryTracker::GetName(MemoryTag tag)
+{
+	switch (tag)
+	{
+	case MemoryTag::Core: return "Core";
+	case MemoryTag::ECS: return "ECS";
+	case MemoryTag::Renderer: return "Renderer";
+	case MemoryTag::Assets: return "Assets";
+	default: return "Unknown";
+	}
+}
+
+void MemoryTracker::SetBudget(MemoryTag tag, size_t bytes)
+{
+	TagCounters& tagCounters = CountersOf(tag);
+	tagCounters.budget.store(bytes, std::memory_order_relaxed);
+	tagCounters.overBudget.store(false, std::memory_order_relaxed);
+}
+
+void MemoryTracker::SetCallstackSampling(uint32_t everyN)
+{
+	sampleEvery.store(everyN, std::memory_order_relaxed);
+}
+
+void MemoryTracker::Dump(std::ostream& out)
+{
+	out << std::left << std::setw(10) << "Tag" << std::right
+		<< std::setw(14) << "Live" << std::setw(14) << "Peak" << std::setw(14) << "Budget"
+		<< std::setw(12) << "Allocs" << std::setw(12) << "Frees" << '\n';
+	for (size_t i = 0; i < static_cast<size_t>(MemoryTag::Count); ++i)
+	{
+		const MemoryTag tag = static_cast<MemoryTag>(i);
+		const MemoryTagStats stats = GetStats(tag);
+		out << std::left << std::setw(10) << GetName(tag) << std::right
+			<< std::setw(14) << stats.liveBytes << std::setw(14) << stats.peakBytes << std::setw(14) << stats.budget
+			<< std::setw(12) << stats.allocations << std::setw(12) << stats.frees << '\n';
+	}
+
+	std::vector<Sample> samples;
+	{
+		SampleRing& ring = Samples();
+		std::lock_guard<std::mutex> lock(ring.mutex);
+		samples.assign(ring.samples.begin(), ring.samples.begin() + ring.count);
+	}
+	std::sort(samples.begin(), samples.end(), [](const Sample& a, const Sample& b) { return a.size > b.size; });
+
+	for (const Sample& sample : samples)
+	{
+		out << '\n' << GetName(sample.tag) << ' ' << sample.size << " bytes\n";
+#if defined(__linux__) || defined(__APPLE__)
+		// Skips RecordSample and Allocate themselves.
+		const int skip = std::min<int>(2, sample.frameCount);
+		char** symbols = backtrace_symbols(sample.frames.data() + skip, static_cast<int>(sample.frameCount) - skip);
+		for (int frame = 0; symbols && frame < static_cast<int>(sample.frameCount) - skip; ++frame)
+		{
+			out << "  " << symbols[frame] << '\n';
+		}
+		std::free(symbols);
+#else
+		for (uint32_t frame = 0; frame < sample.frameCount; ++frame)
+		{
+			out << "  " << sample.frames[frame] << '\n';
+		}
+#endif
+	}
+	out.flush();
+}
+
+uint64_t MemoryTracker::GetThreadAllocationCount()
+{
+	return threadAllocations;
+}
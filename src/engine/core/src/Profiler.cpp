@@ -0,0 +1,244 @@
+#include "../include/Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define ENGINE_PROFILER_TSC
+#endif
+
+namespace
+{
+	struct Event
+	{
+		const char* name;
+		uint64_t start;
+		std::atomic<uint64_t> end;
+	};
+
+	// Written only by its thread; the capture writer reads events below the published
+	// count and may see a zone still open, which it closes at the end of the capture.
+	struct ThreadBuffer
+	{
+		uint32_t id = 0;
+		std::string name;
+		std::unique_ptr<Event[]> events{ new Event[Profiler::MaxEventsPerThread] };
+		std::atomic<uint32_t> count{ 0 };
+		std::atomic<uint32_t> generation{ 0 };
+		std::atomic<uint32_t> dropped{ 0 };
+	};
+
+	uint64_t Now()
+	{
+#if defined(ENGINE_PROFILER_TSC)
+		return __rdtsc();
+#else
+		return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+	}
+
+	struct CaptureState
+	{
+		std::mutex mutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> threads;
+		// Capture number, so buffers reset themselves on their first event of a new one.
+		std::atomic<uint32_t> generation{ 0 };
+		uint32_t framesLeft = 0;
+		std::string path;
+		uint64_t startTicks = 0;
+		uint64_t endTicks = 0;
+		std::chrono::steady_clock::time_point startTime;
+		std::chrono::steady_clock::time_point endTime;
+	};
+
+	CaptureState& State()
+	{
+		static CaptureState state;
+		return state;
+	}
+
+	thread_local ThreadBuffer* localBuffer = nullptr;
+	thread_local std::string pendingThreadName;
+
+	ThreadBuffer& GetLocalBuffer()
+	{
+		if (!localBuffer)
+		{
+			CaptureState& state = State();
+			std::lock_guard<std::mutex> lock(state.mutex);
+			state.threads.push_back(std::make_unique<ThreadBuffer>());
+			localBuffer = state.threads.back().get();
+			localBuffer->id = static_cast<uint32_t>(state.threads.size());
+			localBuffer->name = pendingThreadName.empty() ? "Thread " + std::to_string(localBuffer->id) : pendingThreadName;
+		}
+		return *localBuffer;
+	}
+
+	void WriteEscaped(std::ostream& out, const std::string& text)
+	{
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+			{
+				out << '\\';
+			}
+			out << c;
+		}
+	}
+}
+
+void Profiler::StartCapture(uint32_t frameCount, std::string path)
+{
+	CaptureState& state = State();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	state.framesLeft = frameCount;
+	state.path = std::move(path);
+	state.startTime = std::chrono::steady_clock::now();
+	state.startTicks = Now();
+	state.generation.fetch_add(1, std::memory_order_relaxed);
+	capturing.store(frameCount > 0, std::memory_order_release);
+}
+
+void Profiler::EndFrame()
+{
+	CaptureState& state = State();
+	if (!capturing.load(std::memory_order_relaxed))
+	{
+		return;
+	}
+	std::string path;
+	{
+		std::lock_guard<std::mutex> lock(state.mutex);
+		if (--state.framesLeft > 0)
+		{
+			return;
+		}
+		state.endTicks = Now();
+		state.endTime = std::chrono::steady_clock::now();
+		capturing.store(false, std::memory_order_relaxed);
+		path = state.path;
+	}
+	if (!path.empty())
+	{
+		WriteTrace(path);
+	}
+}
+
+void Profiler::SetThreadName(std::string name)
+{
+	if (localBuffer)
+	{
+		std::lock_guard<std::mutex> lock(State().mutex);
+		localBuffer->name = std::move(name);
+	}
+	else
+	{
+		pendingThreadName = std::move(name);
+	}
+}
+
+uint64_t Profiler::Begin(const char* name)
+{
+	CaptureState& state = State();
+	if (!capturing.load(std::memory_order_relaxed))
+	{
+		return NoEvent;
+	}
+	ThreadBuffer& buffer = GetLocalBuffer();
+	const uint32_t generation = state.generation.load(std::memory_order_relaxed);
+	if (buffer.generation.load(std::memory_order_relaxed) != generation)
+	{
+		buffer.count.store(0, std::memory_order_relaxed);
+		buffer.dropped.store(0, std::memory_order_relaxed);
+		buffer.generation.store(generation, std::memory_order_release);
+	}
+	const uint32_t index = buffer.count.load(std::memory_order_relaxed);
+	if (index == MaxEventsPerThread)
+	{
+		buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+		return NoEvent;
+	}
+	Event& event = buffer.events[index];
+	event.name = name;
+	event.end.store(0, std::memory_order_relaxed);
+	event.start = Now();
+	buffer.count.store(index + 1, std::memory_order_release);
+	return uint64_t(generation) << 32 | index;
+}
+
+void Profiler::End(uint64_t token)
+{
+	if (token == NoEvent)
+	{
+		return;
+	}
+	const uint64_t now = Now();
+	ThreadBuffer& buffer = *localBuffer;
+	if (buffer.generation.load(std::memory_order_relaxed) != static_cast<uint32_t>(token >> 32))
+	{
+		return;
+	}
+	buffer.events[static_cast<uint32_t>(token)].end.store(now, std::memory_order_relaxed);
+}
+
+bool Profiler::WriteTrace(const std::string& path)
+{
+	std::ofstream out(path);
+	if (!out)
+	{
+		std::cerr << "Failed to open " << path << " for the profile trace" << std::endl;
+		return false;
+	}
+
+	CaptureState& state = State();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	// Timestamp ticks per microsecond, measured over the capture.
+	const double micros = std::chrono::duration<double, std::micro>(state.endTime - state.startTime).count();
+	const double ticksPerMicro = micros > 0.0 ? static_cast<double>(state.endTicks - state.startTicks) / micros : 1.0;
+	const uint32_t generation = state.generation.load(std::memory_order_relaxed);
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	for (const auto& buffer : state.threads)
+	{
+		out << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->id << ",\"args\":{\"name\":\"";
+		WriteEscaped(out, buffer->name);
+		out << "\"}}";
+		first = false;
+		if (buffer->generation.load(std::memory_order_acquire) != generation)
+		{
+			continue;
+		}
+		const uint32_t count = buffer->count.load(std::memory_order_acquire);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const Event& event = buffer->events[i];
+			uint64_t end = event.end.load(std::memory_order_relaxed);
+			if (end == 0 || end > state.endTicks)
+			{
+				end = state.endTicks;
+			}
+			const double start = static_cast<double>(event.start - state.startTicks) / ticksPerMicro;
+			const double duration = static_cast<double>(end - std::min(end, event.start)) / ticksPerMicro;
+			out << ",\n{\"ph\":\"X\",\"name\":\"";
+			WriteEscaped(out, event.name);
+			out << "\",\"pid\":1,\"tid\":" << buffer->id << ",\"ts\":" << start << ",\"dur\":" << duration << "}";
+		}
+		if (const uint32_t dropped = buffer->dropped.load(std::memory_order_relaxed))
+		{
+			std::cerr << "Profiler dropped " << dropped << " events on " << buffer->name << std::endl;
+		}
+	}
+	out << "\n]}\n";
+	return true;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "ChunkPool.h"
+#include "ComponentType.h"
+#include "Entity.h"
+#include "../../core/include/MemoryTracker.h"
+
+// Entities sharing the same set of component types. Rows are packed into fixed-size
+// chunks drawn from a ChunkPool, each holding one contiguous array per component type
+// (SoA). A chunk starts with one change version per column, bumped whenever the column
+// may have been written. Tag components are not part of the signature; each tag used by
+// a row of the archetype gets one bit per row, GetTagWords() 64-bit words per chunk.
+class Archetype
+{
+public:
+	static constexpr size_t ChunkSize = ChunkPool::ChunkSize;
+
+	struct Chunk
+	{
+		std::byte* data = nullptr;
+		uint32_t count = 0;
+	};
+
+	// Consecutive rows of one chunk.
+	struct RowRange
+	{
+		uint32_t chunk = 0;
+		uint32_t first = 0;
+		uint32_t count = 0;
+	};
+
+	Archetype(const Signature& signature, ChunkPool& pool);
+	~Archetype();
+
+	Archetype(const Archetype&) = delete;
+	Archetype& operator=(const Archetype&) = delete;
+
+	const Signature& GetSignature() const { return signature; }
+	const EcsVector<ComponentTypeId>& GetTypes() const { return types; }
+	const EcsVector<ComponentInfo>& GetComponents() const { return components; }
+	int FindColumn(ComponentTypeId type) const { return columnIndex[type]; }
+
+	uint32_t GetChunkCapacity() const { return chunkCapacity; }
+	size_t GetChunkCount() const { return chunks.size(); }
+	size_t GetEntityCount() const { return entityCount; }
+	// Chunks taken from the pool over the archetype's lifetime.
+	size_t GetChunkCheckouts() const { return chunkCheckouts; }
+	// Bumped whenever rows are added, removed or rearranged, so component pointers cached
+	// from this archetype's chunks are known to be valid while it is unchanged.
+	uint64_t GetLayoutVersion() const { return layoutVersion; }
+	Chunk& GetChunk(size_t index) { return chunks[index]; }
+	const Chunk& GetChunk(size_t index) const { return chunks[index]; }
+
+	Entity* GetEntities(const Chunk& chunk) const
+	{
+		return reinterpret_cast<Entity*>(chunk.data + entitiesOffset);
+	}
+
+	uint32_t* GetVersions(const Chunk& chunk) const
+	{
+		return reinterpret_cast<uint32_t*>(chunk.data);
+	}
+
+	uint32_t GetVersion(const Chunk& chunk, size_t column) const
+	{
+		return GetVersions(chunk)[column];
+	}
+
+	void MarkChanged(const Chunk& chunk, size_t column, uint32_t version) const
+	{
+		GetVersions(chunk)[column] = version;
+	}
+
+	void* GetColumn(const Chunk& chunk, size_t column) const
+	{
+		return chunk.data + columnOffsets[column];
+	}
+
+	template <typename T>
+	T* GetColumn(const Chunk& chunk, size_t column) const
+	{
+		return reinterpret_cast<T*>(GetColumn(chunk, column));
+	}
+
+	void* GetComponent(uint32_t chunk, uint32_t row, size_t column) const
+	{
+		return chunks[chunk].data + columnOffsets[column] + row * components[column].size;
+	}
+
+	size_t GetTagWords() const { return tagWords; }
+	// Tags that have bit storage in this archetype, in first-use order.
+	const EcsVector<ComponentTypeId>& GetTagTypes() const { return tagTypes; }
+
+	// Bits of tag for chunk, or null if no row of this archetype has ever had it. Bits
+	// past the chunk's row count are always zero.
+	const uint64_t* GetTagBits(ComponentTypeId tag, size_t chunk) const
+	{
+		const EcsVector<uint64_t>& bits = tagBits[tag];
+		return bits.empty() ? nullptr : bits.data() + chunk * tagWords;
+	}
+
+	bool HasTag(ComponentTypeId tag, uint32_t chunk, uint32_t row) const
+	{
+		const uint64_t* bits = GetTagBits(tag, chunk);
+		return bits && (bits[row / 64] >> (row % 64) & 1);
+	}
+
+	// Bits of tag for every chunk, created on first use.
+	EcsVector<uint64_t>& GetTagStorage(ComponentTypeId tag);
+	void SetTag(ComponentTypeId tag, uint32_t chunk, uint32_t row, bool value);
+	// Sets tag on count rows starting at first, a word at a time.
+	void SetTagRange(ComponentTypeId tag, uint32_t chunk, uint32_t first, uint32_t count);
+	size_t GetTagCount(ComponentTypeId tag) const;
+	size_t GetTagBytes(ComponentTypeId tag) const { return tagBits[tag].capacity() * sizeof(uint64_t); }
+
+	// Appends a row for entity. Component memory in the new row is left uninitialised.
+	// Every column of the receiving chunk is marked changed at version.
+	std::pair<uint32_t, uint32_t> AllocateRow(Entity entity, uint32_t version);
+
+	// Fills the hole at (chunk, row) with the archetype's last row. The components at
+	// (chunk, row) must already have been destroyed or moved out. If a row had to be
+	// moved, the hole's chunk is marked changed at version.
+	void RemoveRow(uint32_t chunk, uint32_t row, uint32_t version);
+
+	// Resizes the archetype to chunkCount chunks holding counts[i] rows each and clears
+	// every tag bit. Rows are neither constructed nor destroyed, so this is only for
+	// restoring saved chunk images of trivially copyable components.
+	void SetChunkCounts(const uint32_t* counts, size_t chunkCount);
+
+	// Appends up to count rows to the last chunk, starting a new one if it is full, and
+	// returns the rows added. Entity slots and component memory are left uninitialised.
+	RowRange AllocateRows(size_t count, uint32_t version);
+
+	Archetype* GetAddEdge(ComponentTypeId type) const { return addEdges[type]; }
+	Archetype* GetRemoveEdge(ComponentTypeId type) const { return removeEdges[type]; }
+	void SetAddEdge(ComponentTypeId type, Archetype* target) { addEdges[type] = target; }
+	void SetRemoveEdge(ComponentTypeId type, Archetype* target) { removeEdges[type] = target; }
+
+private:
+	void MarkAllChanged(const Chunk& chunk, uint32_t version) const;
+
+	ChunkPool* pool;
+	Signature signature;
+	EcsVector<ComponentTypeId> types;
+	EcsVector<ComponentInfo> components;
+	std::array<int, MaxComponentTypes> columnIndex;
+	EcsVector<size_t> columnOffsets;
+	size_t entitiesOffset = 0;
+	uint32_t chunkCapacity = 0;
+	size_t entityCount = 0;
+	size_t chunkCheckouts = 0;
+	uint64_t layoutVersion = 0;
+	EcsVector<Chunk> chunks;
+	size_t tagWords = 0;
+	Signature tagged;
+	EcsVector<ComponentTypeId> tagTypes;
+	std::array<EcsVector<uint64_t>, MaxComponentTypes> tagBits;
+	std::array<Archetype*, MaxComponentTypes> addEdges = {};
+	std::array<Archetype*, MaxComponentTypes> removeEdges = {};
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Recycles the fixed-size blocks archetypes store their rows in. Freed chunks go on an
+// intrusive free list, so once a world has reached its peak size, creating and destroying
+// entities no longer reaches the system allocator. Not thread-safe; structural changes
+// only happen on the thread that owns the ECSManager.
+class ChunkPool
+{
+public:
+	static constexpr size_t ChunkSize = 16 * 1024;
+	static constexpr size_t ChunkAlignment = 64;
+
+	struct Stats
+	{
+		size_t systemAllocations = 0;
+		size_t systemFrees = 0;
+		size_t chunksInUse = 0;
+		size_t chunksPooled = 0;
+	};
+
+	ChunkPool() = default;
+	~ChunkPool();
+
+	ChunkPool(const ChunkPool&) = delete;
+	ChunkPool& operator=(const ChunkPool&) = delete;
+
+	std::byte* Allocate();
+	void Free(std::byte* chunk);
+
+	// Returns every pooled chunk to the system allocator.
+	void Trim();
+
+	const Stats& GetStats() const { return stats; }
+
+private:
+	struct FreeChunk
+	{
+		FreeChunk* next;
+	};
+
+	FreeChunk* freeList = nullptr;
+	Stats stats;
+};
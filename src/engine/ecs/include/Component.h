@@ -1,9 +1,68 @@
 #pragma once
 
 #include <cstdint>
+#include <type_traits>
 
+// Optional base for components. Storage is type-erased through ComponentInfo, so no
+// virtual destructor is needed and derived components stay trivially copyable.
 struct Component 
 {
   using IdType = uint32_t;
-  virtual ~Component() = default;
-};
\ No newline at end of file
+};
+
+// Where a component type lives. Archetype storage is the default and keeps components
+// in dense chunk columns; SparseSet suits components that are added and removed often,
+// since toggling them never moves the entity between archetypes. Tags are data-free
+// flags kept as one bit per row in the entity's chunk; they never move entities either.
+enum class ComponentStorage
+{
+  Archetype,
+  SparseSet,
+  Tag
+};
+
+// Empty types default to Tag, everything else to Archetype. Components opt in to another
+// storage with: static constexpr ComponentStorage Storage = ComponentStorage::SparseSet;
+template <typename T, typename = void>
+struct ComponentStorageOf
+{
+  static constexpr ComponentStorage value = std::is_empty_v<T> ? ComponentStorage::Tag : ComponentStorage::Archetype;
+};
+
+template <typename T>
+struct ComponentStorageOf<T, std::void_t<decltype(T::Storage)>>
+{
+  static constexpr ComponentStorage value = T::Storage;
+};
+
+template <typename T>
+inline constexpr bool IsSparseComponent = ComponentStorageOf<T>::value == ComponentStorage::SparseSet;
+
+template <typename T>
+inline constexpr bool IsTagComponent = ComponentStorageOf<T>::value == ComponentStorage::Tag;
+
+// Whether WorldSnapshot writes a component. Snapshots store raw bytes, so a component
+// holding pointers, references or handles into the running process must stay out of
+// them even when it is trivially copyable. Components with data declare either
+//   static constexpr bool Persistent = true;  (saved; must be trivially copyable)
+//   static constexpr bool Persistent = false; (runtime state, left out of snapshots)
+// Tags carry no data and are saved unless they declare otherwise.
+enum class ComponentPersistence
+{
+  Undeclared,
+  Saved,
+  Skipped
+};
+
+template <typename T, typename = void>
+struct ComponentPersistenceOf
+{
+  static constexpr ComponentPersistence value = IsTagComponent<T> ? ComponentPersistence::Saved : ComponentPersistence::Undeclared;
+};
+
+template <typename T>
+struct ComponentPersistenceOf<T, std::void_t<decltype(T::Persistent)>>
+{
+  static_assert(!T::Persistent || std::is_trivially_copyable_v<T>, "persistent components must be trivially copyable");
+  static constexpr ComponentPersistence value = T::Persistent ? ComponentPersistence::Saved : ComponentPersistence::Skipped;
+};
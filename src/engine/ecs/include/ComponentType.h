@@ -0,0 +1,189 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ChunkPool.h"
+#include "Component.h"
+#include "Entity.h"
+#include "SparseSet.h"
+
+using ComponentTypeId = uint32_t;
+
+constexpr size_t MaxComponentTypes = 64;
+constexpr ComponentTypeId InvalidComponentType = ~ComponentTypeId(0);
+
+// One bit per ComponentTypeId; describes the component set of an entity or archetype.
+using Signature = std::bitset<MaxComponentTypes>;
+
+// Readable type name taken from the compiler's function signature, no RTTI involved.
+template <typename T>
+constexpr std::string_view TypeName()
+{
+#if defined(_MSC_VER)
+	constexpr std::string_view signature = __FUNCSIG__;
+	constexpr std::string_view prefix = "TypeName<";
+	constexpr std::string_view suffix = ">(void)";
+	std::string_view name = signature.substr(signature.find(prefix) + prefix.size());
+	name = name.substr(0, name.size() - suffix.size());
+	for (std::string_view keyword : { std::string_view("struct "), std::string_view("class ") })
+	{
+		if (name.substr(0, keyword.size()) == keyword)
+		{
+			name.remove_prefix(keyword.size());
+		}
+	}
+	return name;
+#else
+	constexpr std::string_view signature = __PRETTY_FUNCTION__;
+	constexpr std::string_view prefix = "T = ";
+	std::string_view name = signature.substr(signature.find(prefix) + prefix.size());
+	return name.substr(0, name.find_first_of(";]"));
+#endif
+}
+
+// Layout and lifetime operations of a component type, used by type-erased storage.
+struct ComponentInfo
+{
+	std::string_view name;
+	size_t size;
+	size_t alignment;
+	void (*moveConstruct)(void* dst, void* src);
+	// Null for types that cannot be copied.
+	void (*copyConstruct)(void* dst, const void* src);
+	void (*destroy)(void* ptr);
+	// Copies may be made with memcpy.
+	bool trivial;
+	// Set for ComponentStorage::SparseSet types only.
+	SparseSetBase* (*createSparseSet)();
+	// ComponentStorage::Tag: never given a column; archetypes keep per-chunk bits instead.
+	bool tag;
+	ComponentPersistence persistence;
+
+	template <typename T>
+	static ComponentInfo Create()
+	{
+		void (*copyConstruct)(void*, const void*) = nullptr;
+		if constexpr (std::is_copy_constructible_v<T>)
+		{
+			copyConstruct = [](void* dst, const void* src) { new (dst) T(*static_cast<const T*>(src)); };
+		}
+		SparseSetBase* (*createSparseSet)() = nullptr;
+		if constexpr (IsSparseComponent<T>)
+		{
+			createSparseSet = []() -> SparseSetBase* { return new SparseSet<T>(); };
+		}
+		else if constexpr (!IsTagComponent<T>)
+		{
+			// A chunk must hold at least one row: its column version, entity and value.
+			constexpr size_t header = ((sizeof(uint32_t) + alignof(Entity) - 1) & ~(alignof(Entity) - 1)) + sizeof(Entity);
+			constexpr size_t offset = (header + alignof(T) - 1) & ~(alignof(T) - 1);
+			static_assert(alignof(T) <= ChunkPool::ChunkAlignment, "component alignment exceeds the chunk alignment; use sparse-set storage");
+			static_assert(offset + sizeof(T) <= ChunkPool::ChunkSize, "component does not fit in an archetype chunk; use sparse-set storage");
+		}
+		return {
+			TypeName<T>(),
+			sizeof(T),
+			alignof(T),
+			[](void* dst, void* src) { new (dst) T(std::move(*static_cast<T*>(src))); },
+			copyConstruct,
+			[](void* ptr) { static_cast<T*>(ptr)->~T(); },
+			std::is_trivially_copyable_v<T>,
+			createSparseSet,
+			IsTagComponent<T>,
+			ComponentPersistenceOf<T>::value
+		};
+	}
+};
+
+// Registration may happen lazily from any thread. Entries live in a fixed array and are
+// never moved, so references from GetInfo stay valid; an entry is written under the
+// mutex before the count that publishes it.
+class ComponentRegistry
+{
+public:
+	static ComponentTypeId Register(const ComponentInfo& info)
+	{
+		Registry& registry = Instance();
+		std::lock_guard<std::mutex> lock(registry.mutex);
+		const size_t id = registry.count.load(std::memory_order_relaxed);
+		if (id >= MaxComponentTypes)
+		{
+			std::cerr << "Too many component types registering " << info.name << "; raise MaxComponentTypes" << std::endl;
+			std::abort();
+		}
+		registry.infos[id] = info;
+		registry.count.store(id + 1, std::memory_order_release);
+		return static_cast<ComponentTypeId>(id);
+	}
+
+	static const ComponentInfo& GetInfo(ComponentTypeId id) { return Instance().infos[id]; }
+	static size_t GetCount() { return Instance().count.load(std::memory_order_acquire); }
+
+	// Id of the type registered under name, or InvalidComponentType. Ids depend on
+	// registration order, so persisted data refers to types by name.
+	static ComponentTypeId Find(std::string_view name)
+	{
+		const Registry& registry = Instance();
+		const size_t count = registry.count.load(std::memory_order_acquire);
+		for (size_t id = 0; id < count; ++id)
+		{
+			if (registry.infos[id].name == name)
+			{
+				return static_cast<ComponentTypeId>(id);
+			}
+		}
+		return InvalidComponentType;
+	}
+
+private:
+	struct Registry
+	{
+		std::array<ComponentInfo, MaxComponentTypes> infos{};
+		std::atomic<size_t> count{ 0 };
+		std::mutex mutex;
+	};
+
+	static Registry& Instance()
+	{
+		static Registry registry;
+		return registry;
+	}
+};
+
+// Dense per-type id, registered on first use, so it is valid even from other static
+// initialisers. After that, reading it is a guard check and a load.
+template <typename T>
+struct ComponentType
+{
+	static ComponentTypeId Get()
+	{
+		static const ComponentTypeId id = ComponentRegistry::Register(ComponentInfo::Create<T>());
+		return id;
+	}
+};
+
+// const T names the same component; views use it to request read-only access.
+template <typename T>
+struct ComponentType<const T> : ComponentType<T>
+{
+};
+
+template <typename... Ts>
+Signature MakeSignature()
+{
+	Signature signature;
+	(signature.set(ComponentType<Ts>::Get()), ...);
+	return signature;
+}
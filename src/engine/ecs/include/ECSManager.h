@@ -1,30 +1,440 @@
 #pragma once
 
-#include <unordered_map>
+#include <algorithm>
+#include <cassert>
+#include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <ostream>
+#include <span>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
 #include <vector>
+#include "Archetype.h"
+#include "ChunkPool.h"
+#include "EntityCommandBuffer.h"
+#include "Prefab.h"
+#include "ComponentType.h"
+#include "SparseSet.h"
+#include "View.h"
 #include "Entity.h"
 #include "Component.h"
 #include "System.h"
+#include "SystemScheduler.h"
+#include "../../core/include/JobSystem.h"
+
+// Memory held for one component type across all archetypes or its sparse set.
+struct ComponentMemoryStats
+{
+	std::string_view name;
+	size_t count = 0;
+	size_t bytes = 0;
+	// Heap allocations made by the type's sparse-set pool.
+	size_t allocations = 0;
+	// Chunks taken from the ChunkPool by archetypes holding the type; only the pool's
+	// system allocations reach the heap.
+	size_t chunkCheckouts = 0;
+};
 
 class ECSManager
 {
 public:
+	ECSManager();
+	ECSManager(const ECSManager&) = delete;
+	ECSManager& operator=(const ECSManager&) = delete;
+
 	Entity CreateEntity();
 	void DestroyEntity(Entity entity);
-	
+
+	// Creates count entities holding copies of prefab's components, filling archetype
+	// chunks in bulk. The returned handles stay valid until the next Instantiate call.
+	std::span<const Entity> Instantiate(const Prefab& prefab, size_t count);
+
+	// True while entity has not been destroyed. A bounds check plus one record load.
+	bool IsAlive(Entity entity) const
+	{
+		// Free slots have no archetype. After a rollback restore that is what rejects
+		// handles issued in the discarded future, whose generation the slot still carries.
+		return entity.GetId() < entityRecords.size() && entityRecords[entity.GetId()].generation == entity.GetGeneration()
+			&& entityRecords[entity.GetId()].archetype;
+	}
+
+	size_t GetEntityCount() const { return entityRecords.size() - freeIndices.size(); }
+
+	// Tags only set the entity's bit; the returned reference is a shared empty instance.
 	template <typename T, typename... Args>
-	void AddComponent(Entity entity, Args&&... args);
+	T& AddComponent(Entity entity, Args&&... args);
+
+	template <typename T>
+	void RemoveComponent(Entity entity);
 
+	// Mutable access; marks the component's chunk column as changed.
 	template <typename T>
 	T* GetComponent(Entity entity);
 
-	void AddSystem(std::shared_ptr<System> system);
+	// Read-only access that leaves change versions untouched.
+	template <typename T>
+	const T* ReadComponent(Entity entity) const;
+
+	template <typename T>
+	bool HasComponent(Entity entity) const;
+
+	// Change version of the chunk column holding entity's T, or 0 if it has none. Only
+	// archetype components carry versions; tags and sparse-set components do not.
+	template <typename T>
+	uint32_t GetComponentVersion(Entity entity) const;
+
+	// Pool backing a component declared with ComponentStorage::SparseSet.
+	template <typename T>
+	SparseSet<T>& GetSparseSet();
+
+	// Entities owning all of Ts. The matching archetype list is resolved on first use
+	// and kept up to date as new archetypes are created. Use const Ts for components
+	// that are only read so their chunks are not marked changed, and the view's With and
+	// Without to filter on tags.
+	template <typename... Ts>
+	ComponentView<Ts...> View();
+
+	// Calls func(Entity, Ts&...) for every entity owning all of Ts.
+	template <typename... Ts, typename Func>
+	void Each(Func&& func);
+
+	// Each spread over the job system a chunk at a time; see ComponentView::ParallelForEach.
+	template <typename... Ts, typename Func>
+	void ParallelForEach(Func&& func);
+
+	void AddSystem(std::shared_ptr<System> system, SystemGroupId group = DefaultSystemGroup);
 	std::vector<std::shared_ptr<System>>& GetSystems();
+
+	// Group for systems that need not run on every update, e.g. AI or LOD selection at a
+	// lower rate, optionally time-sliced and held to a CPU budget; see SystemGroupSettings.
+	SystemGroupId AddSystemGroup(std::string name, const SystemGroupSettings& settings);
+	const SystemGroups& GetSystemGroups() const { return systemGroups; }
+
+	// Per-system run times, entity and allocation counts; enable to start recording.
+	SystemTimings& GetSystemTimings() { return systemTimings; }
+
+	// Runs every system whose group is due once, overlapping those whose declared
+	// component access does not conflict. The schedule is cached until the system list
+	// changes. System entity sets are refreshed first and command buffers are played
+	// back once all systems have finished.
 	void UpdateSystems(float deltaTime);
 
+	// Brings every System::GetEntities set up to date with the entities whose components
+	// changed since the last refresh. UpdateSystems calls it once per frame.
+	void RefreshSystemEntities();
+
+	// Buffer owned by the calling thread. Systems must record structural changes here
+	// instead of calling CreateEntity/DestroyEntity/AddComponent/RemoveComponent.
+	EntityCommandBuffer& GetCommandBuffer();
+
+	// Applies every recorded command in one pass sorted by entity, so each entity moves
+	// between archetypes at most once. Called automatically at the end of UpdateSystems.
+	void PlaybackCommandBuffers();
+
+	// Job system used by UpdateSystems. Either share one with the rest of the engine or
+	// let the manager create its own with the given worker count (by default one less
+	// than the hardware thread count).
+	void SetJobSystem(JobSystem* jobSystem);
+	void SetWorkerCount(size_t count);
+	JobSystem& GetJobSystem();
+	void DumpSchedule(std::ostream& out);
+
+	// Per registered component type, indexed by ComponentTypeId. Archetype components
+	// report the column bytes of every chunk they live in and the chunks those
+	// archetypes took from the pool; sparse components report their pool's arrays.
+	std::vector<ComponentMemoryStats> GetComponentMemoryStats() const;
+	const ChunkPool::Stats& GetChunkStats() const { return chunkPool.GetStats(); }
+	void DumpMemoryStats(std::ostream& out) const;
+
+	// Releases pooled chunks no archetype is using back to the system allocator.
+	void TrimMemory() { chunkPool.Trim(); }
+
+	// Version stamped on component writes made now: the running system's version inside
+	// UpdateSystems, otherwise the current world version. Compare against
+	// System::GetLastRunVersion or a value saved earlier to detect changes.
+	uint32_t GetChangeVersion() const
+	{
+		uint32_t running = System::GetRunningVersion();
+		return running ? running : changeVersion.load(std::memory_order_relaxed);
+	}
+
 private:
-	Entity::IdType nextEntityId = 0;
-	std::unordered_map<Entity::IdType, std::vector<std::shared_ptr<Component>>> components;
+	friend class WorldSnapshot;
+	friend class RollbackBuffer;
+
+	struct EntityRecord
+	{
+		Archetype* archetype = nullptr;
+		uint32_t chunk = 0;
+		uint32_t row = 0;
+		Entity::GenerationType generation = 0;
+		// Queued in dirtyEntities for the next system membership refresh.
+		bool dirty = false;
+	};
+
+	template <typename T>
+	auto ViewPool();
+
+	struct PendingCommand
+	{
+		Entity entity;
+		uint32_t order;
+		EntityCommandBuffer::Command* command;
+	};
+
+	Entity::IdType AllocateIndex();
+	const EntityRecord* FindRecord(Entity entity) const;
+	bool Matches(const EntityRecord& record, Entity entity, const Signature& required) const;
+	void MarkDirty(Entity::IdType index);
+	void ApplyCommands(Entity entity, const PendingCommand* begin, const PendingCommand* end);
+	void ResizeCommandBuffers(size_t threadCount);
+	QueryCache& GetQueryCache(const Signature& required);
+	Archetype* GetOrCreateArchetype(const Signature& signature);
+	Archetype* GetArchetypeWith(Archetype* source, ComponentTypeId type);
+	Archetype* GetArchetypeWithout(Archetype* source, ComponentTypeId type);
+	void MoveEntity(Entity entity, Archetype* target);
+	void RemoveRow(Archetype* archetype, uint32_t chunk, uint32_t row);
+
+	EcsVector<EntityRecord> entityRecords;
+	EcsVector<Entity::IdType> freeIndices;
+	std::array<std::unique_ptr<SparseSetBase>, MaxComponentTypes> sparseSets;
+	// Declared before the archetypes so it outlives them.
+	ChunkPool chunkPool;
+	EcsUnorderedMap<Signature, std::unique_ptr<Archetype>> archetypeIndex;
+	EcsVector<Archetype*> archetypes;
+	Archetype* emptyArchetype = nullptr;
+	EcsUnorderedMap<Signature, std::unique_ptr<QueryCache>> queries;
+	std::mutex queryMutex;
 	std::vector<std::shared_ptr<System>> systems;
-};
\ No newline at end of file
+	EcsVector<System*> matchingSystems;
+	EcsVector<Entity::IdType> dirtyEntities;
+	bool membershipStale = false;
+	SystemScheduler scheduler;
+	SystemGroups systemGroups;
+	std::vector<float> groupMilliseconds;
+	SystemTimings systemTimings;
+	uint64_t updateCount = 0;
+	EcsVector<std::unique_ptr<EntityCommandBuffer>> threadCommandBuffers;
+	EcsUnorderedMap<std::thread::id, std::unique_ptr<EntityCommandBuffer>> foreignCommandBuffers;
+	std::mutex foreignCommandBufferMutex;
+	EcsVector<PendingCommand> pendingCommands;
+	EcsVector<EntityCommandBuffer*> playbackBuffers;
+	EcsVector<Entity> instantiated;
+	EcsVector<const Prefab::Value*> prefabSparseValues;
+	EcsVector<Entity> createdEntities;
+	JobSystem* jobSystem = nullptr;
+	std::unique_ptr<JobSystem> ownedJobSystem;
+	size_t workerCount;
+	std::atomic<uint32_t> changeVersion{ 1 };
+};
+
+template <typename T>
+SparseSet<T>& ECSManager::GetSparseSet()
+{
+	static_assert(IsSparseComponent<T>, "component does not use sparse-set storage");
+	auto& pool = sparseSets[ComponentType<T>::Get()];
+	if (!pool)
+	{
+		pool = std::make_unique<SparseSet<T>>();
+	}
+	return static_cast<SparseSet<T>&>(*pool);
+}
+
+template <typename T, typename... Args>
+T& ECSManager::AddComponent(Entity entity, Args&&... args)
+{
+	if constexpr (IsSparseComponent<T>)
+	{
+		assert(FindRecord(entity) && "AddComponent on a destroyed entity");
+		MarkDirty(entity.GetId());
+		return GetSparseSet<T>().Emplace(entity, std::forward<Args>(args)...);
+	}
+	else if constexpr (IsTagComponent<T>)
+	{
+		assert(FindRecord(entity) && "AddComponent on a destroyed entity");
+		const EntityRecord& record = entityRecords[entity.GetId()];
+		record.archetype->SetTag(ComponentType<T>::Get(), record.chunk, record.row, true);
+		MarkDirty(entity.GetId());
+		static T instance;
+		return instance;
+	}
+	else
+	{
+		assert(FindRecord(entity) && "AddComponent on a destroyed entity");
+
+		const ComponentTypeId type = ComponentType<T>::Get();
+		EntityRecord& record = entityRecords[entity.GetId()];
+		int column = record.archetype->FindColumn(type);
+		if (column >= 0)
+		{
+			T* existing = static_cast<T*>(record.archetype->GetComponent(record.chunk, record.row, column));
+			record.archetype->MarkChanged(record.archetype->GetChunk(record.chunk), column, GetChangeVersion());
+			existing->~T();
+			return *new (existing) T(std::forward<Args>(args)...);
+		}
+
+		Archetype* target = GetArchetypeWith(record.archetype, type);
+		MoveEntity(entity, target);
+		column = target->FindColumn(type);
+		void* memory = target->GetComponent(record.chunk, record.row, column);
+		target->MarkChanged(target->GetChunk(record.chunk), column, GetChangeVersion());
+		return *new (memory) T(std::forward<Args>(args)...);
+	}
+}
+
+template <typename T>
+void ECSManager::RemoveComponent(Entity entity)
+{
+	if constexpr (IsSparseComponent<T>)
+	{
+		if (IsAlive(entity))
+		{
+			GetSparseSet<T>().Remove(entity);
+			MarkDirty(entity.GetId());
+		}
+	}
+	else if constexpr (IsTagComponent<T>)
+	{
+		if (const EntityRecord* record = FindRecord(entity))
+		{
+			record->archetype->SetTag(ComponentType<T>::Get(), record->chunk, record->row, false);
+			MarkDirty(entity.GetId());
+		}
+	}
+	else
+	{
+		const EntityRecord* record = FindRecord(entity);
+		const ComponentTypeId type = ComponentType<T>::Get();
+		if (!record || record->archetype->FindColumn(type) < 0)
+		{
+			return;
+		}
+		MoveEntity(entity, GetArchetypeWithout(record->archetype, type));
+	}
+}
+
+template <typename T>
+T* ECSManager::GetComponent(Entity entity)
+{
+	static_assert(!IsTagComponent<T>, "tags have no data; use HasComponent");
+	if constexpr (IsSparseComponent<T>)
+	{
+		return GetSparseSet<T>().Find(entity);
+	}
+	else
+	{
+		const EntityRecord* record = FindRecord(entity);
+		if (!record)
+		{
+			return nullptr;
+		}
+		int column = record->archetype->FindColumn(ComponentType<T>::Get());
+		if (column < 0)
+		{
+			return nullptr;
+		}
+		record->archetype->MarkChanged(record->archetype->GetChunk(record->chunk), column, GetChangeVersion());
+		return static_cast<T*>(record->archetype->GetComponent(record->chunk, record->row, column));
+	}
+}
+
+template <typename T>
+const T* ECSManager::ReadComponent(Entity entity) const
+{
+	static_assert(!IsTagComponent<T>, "tags have no data; use HasComponent");
+	if constexpr (IsSparseComponent<T>)
+	{
+		const auto& pool = sparseSets[ComponentType<T>::Get()];
+		return pool ? static_cast<const SparseSet<T>&>(*pool).Find(entity) : nullptr;
+	}
+	else
+	{
+		const EntityRecord* record = FindRecord(entity);
+		if (!record)
+		{
+			return nullptr;
+		}
+		int column = record->archetype->FindColumn(ComponentType<T>::Get());
+		if (column < 0)
+		{
+			return nullptr;
+		}
+		return static_cast<const T*>(record->archetype->GetComponent(record->chunk, record->row, column));
+	}
+}
+
+template <typename T>
+bool ECSManager::HasComponent(Entity entity) const
+{
+	if constexpr (IsSparseComponent<T>)
+	{
+		const auto& pool = sparseSets[ComponentType<T>::Get()];
+		return pool && pool->Contains(entity);
+	}
+	else if constexpr (IsTagComponent<T>)
+	{
+		const EntityRecord* record = FindRecord(entity);
+		return record && record->archetype->HasTag(ComponentType<T>::Get(), record->chunk, record->row);
+	}
+	else
+	{
+		const EntityRecord* record = FindRecord(entity);
+		return record && record->archetype->GetSignature().test(ComponentType<T>::Get());
+	}
+}
+
+template <typename T>
+uint32_t ECSManager::GetComponentVersion(Entity entity) const
+{
+	static_assert(!IsSparseComponent<T> && !IsTagComponent<T>, "only archetype components have change versions");
+	const EntityRecord* record = FindRecord(entity);
+	if (!record)
+	{
+		return 0;
+	}
+	int column = record->archetype->FindColumn(ComponentType<T>::Get());
+	return column >= 0 ? record->archetype->GetVersion(record->archetype->GetChunk(record->chunk), column) : 0;
+}
+
+template <typename T>
+auto ECSManager::ViewPool()
+{
+	if constexpr (IsSparseComponent<T>)
+	{
+		return static_cast<SparseSet<std::remove_const_t<T>>*>(sparseSets[ComponentType<T>::Get()].get());
+	}
+	else
+	{
+		return nullptr;
+	}
+}
+
+template <typename... Ts>
+ComponentView<Ts...> ECSManager::View()
+{
+	Signature required;
+	auto require = [&](bool sparse, ComponentTypeId type)
+	{
+		if (!sparse)
+		{
+			required.set(type);
+		}
+	};
+	(require(IsSparseComponent<Ts>, ComponentType<Ts>::Get()), ...);
+	return ComponentView<Ts...>(GetQueryCache(required), { ViewPool<Ts>()... }, GetChangeVersion());
+}
+
+template <typename... Ts, typename Func>
+void ECSManager::Each(Func&& func)
+{
+	View<Ts...>().Each(func);
+}
+
+template <typename... Ts, typename Func>
+void ECSManager::ParallelForEach(Func&& func)
+{
+	View<Ts...>().ParallelForEach(GetJobSystem(), func);
+}
\ No newline at end of file
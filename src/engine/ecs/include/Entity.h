@@ -1,37 +1,48 @@
 #pragma once
 
 #include <cstdint>
-#include <unordered_map>
-#include <memory>
-#include "Component.h"
 
+// Lightweight handle; component data is owned by ECSManager. The handle packs a slot
+// index with a generation that is bumped whenever the slot is recycled, so handles to
+// destroyed entities never alias the entity that reuses their index.
+//
+// Handles are 64-bit (32-bit index, 32-bit generation) by default. Defining
+// ENGINE_ECS_32BIT_ENTITY packs them into 32 bits (22-bit index, 10-bit generation).
 class Entity
 {
 public:
 	using IdType = uint32_t;
+	using GenerationType = uint32_t;
 
-	explicit Entity(IdType id) : id(id) {}
+#if defined(ENGINE_ECS_32BIT_ENTITY)
+	using HandleType = uint32_t;
+	static constexpr unsigned IndexBits = 22;
+#else
+	using HandleType = uint64_t;
+	static constexpr unsigned IndexBits = 32;
+#endif
+	static constexpr unsigned GenerationBits = sizeof(HandleType) * 8 - IndexBits;
+	static constexpr HandleType IndexMask = (HandleType(1) << IndexBits) - 1;
+	static constexpr HandleType GenerationMask = HandleType(~HandleType(0)) >> IndexBits;
 
-	IdType GetId() const { return id; }
+	// Reserved for handles handed out by EntityCommandBuffer before the entity exists;
+	// live entities never carry it.
+	static constexpr GenerationType ProvisionalGeneration = static_cast<GenerationType>(GenerationMask);
 
-	template <typename T>
-	void AddComponent(std::shared_ptr<T> component)
+	explicit Entity(IdType id, GenerationType generation = 0)
+		: handle(static_cast<HandleType>(id) | (static_cast<HandleType>(generation & GenerationMask) << IndexBits))
 	{
-		components[typeid(T).hash_code()] = component;
 	}
 
-	template <typename T>
-	T* GetComponent()
-	{
-		auto it = components.find(typeid(T).hash_code());
-		if (it != components.end())
-		{
-			return static_cast<T*>(it->second.get());
-		}
-		return nullptr;
-	}
+	// Slot index, suitable for indexing dense per-entity arrays.
+	IdType GetId() const { return static_cast<IdType>(handle & IndexMask); }
+	GenerationType GetGeneration() const { return static_cast<GenerationType>(handle >> IndexBits); }
+	HandleType GetHandle() const { return handle; }
+	bool IsProvisional() const { return GetGeneration() == ProvisionalGeneration; }
+
+	bool operator==(const Entity& other) const { return handle == other.handle; }
+	bool operator!=(const Entity& other) const { return handle != other.handle; }
 
 private:
-	IdType id;
-	std::unordered_map<size_t, std::shared_ptr<Component>> components;
-};
\ No newline at end of file
+	HandleType handle;
+};
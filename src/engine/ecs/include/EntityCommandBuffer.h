@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+#include "ComponentType.h"
+#include "Entity.h"
+#include "../../core/include/MemoryTracker.h"
+
+// Records structural changes (create, destroy, add, remove) for later playback by
+// ECSManager, so systems can request them mid-iteration or from worker threads.
+// Each thread records into its own buffer; nothing here takes a lock.
+class EntityCommandBuffer
+{
+public:
+	enum class CommandType : uint8_t
+	{
+		Create,
+		Destroy,
+		AddComponent,
+		RemoveComponent
+	};
+
+	struct Command
+	{
+		CommandType type;
+		ComponentTypeId component;
+		Entity entity;
+		void* payload;
+	};
+
+	EntityCommandBuffer() = default;
+	~EntityCommandBuffer();
+
+	EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+	EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+
+	// Returns a provisional handle that is only valid within this buffer's commands
+	// until playback assigns the real entity.
+	Entity CreateEntity();
+	void DestroyEntity(Entity entity);
+
+	template <typename T, typename... Args>
+	void AddComponent(Entity entity, Args&&... args)
+	{
+		void* payload = AllocatePayload(sizeof(T), alignof(T));
+		new (payload) T(std::forward<Args>(args)...);
+		commands.push_back({ CommandType::AddComponent, ComponentType<T>::Get(), entity, payload });
+	}
+
+	template <typename T>
+	void RemoveComponent(Entity entity)
+	{
+		commands.push_back({ CommandType::RemoveComponent, ComponentType<T>::Get(), entity, nullptr });
+	}
+
+	bool IsEmpty() const { return commands.empty(); }
+	EcsVector<Command>& GetCommands() { return commands; }
+	Entity::IdType GetCreatedCount() const { return createdCount; }
+
+	// Drops all commands, destroying payloads that were not consumed. Payload memory is
+	// kept for reuse.
+	void Clear();
+
+private:
+	static constexpr size_t BlockSize = 64 * 1024;
+
+	struct Block
+	{
+		EcsVector<std::byte> data;
+	};
+
+	void* AllocatePayload(size_t size, size_t alignment);
+
+	EcsVector<Command> commands;
+	EcsVector<Block> blocks;
+	size_t currentBlock = 0;
+	size_t blockOffset = 0;
+	Entity::IdType createdCount = 0;
+};
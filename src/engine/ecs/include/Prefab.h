@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "ComponentType.h"
+#include "../../core/include/MemoryTracker.h"
+
+// Component values to stamp onto many entities at once with ECSManager::Instantiate.
+// Holds one value per component type; setting a type twice replaces its value.
+class Prefab
+{
+public:
+	struct Value
+	{
+		ComponentTypeId type;
+		void* data;
+	};
+
+	Prefab() = default;
+	~Prefab();
+
+	Prefab(const Prefab&) = delete;
+	Prefab& operator=(const Prefab&) = delete;
+
+	template <typename T, typename... Args>
+	T& Set(Args&&... args)
+	{
+		static_assert(std::is_copy_constructible_v<T>, "prefab components are copied into every instance");
+		const ComponentTypeId type = ComponentType<T>::Get();
+		void* memory = Find(type);
+		if (memory)
+		{
+			static_cast<T*>(memory)->~T();
+		}
+		else
+		{
+			memory = MemoryTracker::Allocate(sizeof(T), alignof(T), MemoryTag::ECS);
+			values.push_back({ type, memory });
+			signature.set(type);
+		}
+		return *new (memory) T(std::forward<Args>(args)...);
+	}
+
+	template <typename T>
+	T* Get()
+	{
+		return static_cast<T*>(Find(ComponentType<T>::Get()));
+	}
+
+	const Signature& GetSignature() const { return signature; }
+	const EcsVector<Value>& GetValues() const { return values; }
+
+private:
+	void* Find(ComponentTypeId type) const;
+
+	EcsVector<Value> values;
+	Signature signature;
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include "ComponentType.h"
+#include "../../core/include/MemoryTracker.h"
+
+class ECSManager;
+
+// Fixed ring of recent world states for rollback: save the world every tick, restore any
+// tick still in the ring and simulate forward again. Holds entity slots, the free list,
+// every archetype chunk, tag bits and sparse-set pools; only trivially copyable
+// components are supported. Frames never leave the process, so unlike WorldSnapshot it
+// also keeps components that are not Persistent.
+//
+// Each stored block is a shared base image plus an optional XOR delta against it,
+// run-length encoded so the unchanged bytes cost almost nothing. Chunks whose change
+// versions show no writes since the previous save share that frame's block outright. A
+// block is re-based when its delta grows past a quarter of its size, so restoring is
+// always one copy plus at most one delta per block, however old the frame.
+//
+// Restore stamps every restored chunk as changed so systems recompute derived data, and
+// marks system entity sets for a rebuild on the next UpdateSystems.
+class RollbackBuffer
+{
+public:
+	struct Stats
+	{
+		size_t frames = 0;
+		// Distinct base and delta blocks held across all frames, and their bytes.
+		size_t blocks = 0;
+		size_t bytes = 0;
+	};
+
+	explicit RollbackBuffer(size_t capacity);
+
+	// Stores world as tick, dropping any stored frames at or after tick and then the
+	// oldest frame if the ring is full. Fails if the world holds components that are not
+	// trivially copyable.
+	bool Save(ECSManager& world, uint64_t tick);
+
+	// Restores world to tick. Returns false if tick is not in the ring.
+	bool Restore(ECSManager& world, uint64_t tick);
+
+	bool Contains(uint64_t tick) const { return Find(tick) != nullptr; }
+	size_t GetCapacity() const { return frames.size(); }
+	size_t GetFrameCount() const { return count; }
+	Stats GetStats() const;
+
+private:
+	using Bytes = EcsVector<std::byte>;
+
+	struct Block
+	{
+		std::shared_ptr<const Bytes> base;
+		// XOR against base, run-length encoded; null when the data equals base.
+		std::shared_ptr<const Bytes> delta;
+	};
+
+	struct ArchetypeState
+	{
+		EcsVector<uint32_t> counts;
+		EcsVector<Block> chunks;
+		EcsVector<std::pair<ComponentTypeId, Block>> tags;
+	};
+
+	struct SparseState
+	{
+		ComponentTypeId type = 0;
+		Block entities;
+		Block components;
+	};
+
+	struct Frame
+	{
+		uint64_t tick = 0;
+		Block generations;
+		Block freeIndices;
+		EcsVector<ArchetypeState> archetypes;
+		EcsVector<SparseState> sparse;
+	};
+
+	Frame* Find(uint64_t tick);
+	const Frame* Find(uint64_t tick) const;
+	Frame& At(size_t index) { return frames[(first + index) % frames.size()]; }
+	const Frame& At(size_t index) const { return frames[(first + index) % frames.size()]; }
+
+	Block Encode(const void* data, size_t size, const Block* previous);
+	static void Decode(const Block& block, void* out);
+	static size_t GetSize(const Block& block) { return block.base ? block.base->size() : 0; }
+	static void Release(Frame& frame);
+
+	EcsVector<Frame> frames;
+	// Built here and swapped into the ring, so the frame it diffs against stays intact.
+	Frame pending;
+	size_t first = 0;
+	size_t count = 0;
+	// State the world was last saved as or restored to, which the next Save diffs against.
+	bool hasLast = false;
+	uint64_t lastTick = 0;
+	uint32_t lastVersion = 0;
+	Bytes delta;
+	Bytes entityScratch;
+	Bytes componentScratch;
+	EcsVector<uint32_t> words;
+};
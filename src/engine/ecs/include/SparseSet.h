@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Entity.h"
+#include "../../core/include/MemoryTracker.h"
+
+// Type-erased view of a pool so ECSManager can drop an entity from every pool.
+class SparseSetBase
+{
+public:
+	virtual ~SparseSetBase() = default;
+	virtual bool Contains(Entity entity) const = 0;
+	virtual void Remove(Entity entity) = 0;
+	// Adds or replaces entity's component by moving from an object of the pool's type.
+	virtual void EmplaceMoved(Entity entity, void* source) = 0;
+	// Same, copying; only valid for copy-constructible component types.
+	virtual void EmplaceCopied(Entity entity, const void* source) = 0;
+	virtual void Reserve(size_t count) = 0;
+	// Removes every component, keeping the arrays and pages for reuse.
+	virtual void Clear() = 0;
+	// Dense arrays, Size() elements each, in matching order.
+	virtual const Entity* GetEntityData() const = 0;
+	virtual const void* GetComponentData() const = 0;
+	virtual size_t Size() const = 0;
+	// Bytes held by the dense arrays and sparse pages, including unused capacity.
+	virtual size_t GetReservedBytes() const = 0;
+	// Times the pool has had to grow an array or add a page.
+	size_t GetAllocationCount() const { return allocations; }
+
+protected:
+	size_t allocations = 0;
+};
+
+// Packed component array plus a paged sparse index keyed on entity id. Add, remove and
+// lookup are O(1) and iteration walks the dense arrays with no holes.
+template <typename T>
+class SparseSet : public SparseSetBase
+{
+public:
+	static constexpr size_t PageSize = 4096;
+
+	template <typename... Args>
+	T& Emplace(Entity entity, Args&&... args)
+	{
+		uint32_t& slot = SparseSlot(entity.GetId());
+		if (slot != Tombstone)
+		{
+			T& existing = components[slot];
+			existing.~T();
+			return *new (&existing) T(std::forward<Args>(args)...);
+		}
+
+		slot = static_cast<uint32_t>(entities.size());
+		if (entities.size() == entities.capacity())
+		{
+			allocations += 2;
+		}
+		entities.push_back(entity);
+		return components.emplace_back(std::forward<Args>(args)...);
+	}
+
+	bool Contains(Entity entity) const override
+	{
+		return Lookup(entity) != Tombstone;
+	}
+
+	void Remove(Entity entity) override
+	{
+		uint32_t index = Lookup(entity);
+		if (index == Tombstone)
+		{
+			return;
+		}
+
+		uint32_t last = static_cast<uint32_t>(entities.size() - 1);
+		if (index != last)
+		{
+			Entity moved = entities[last];
+			entities[index] = moved;
+			if constexpr (std::is_move_assignable_v<T>)
+			{
+				components[index] = std::move(components[last]);
+			}
+			else
+			{
+				components[index].~T();
+				new (&components[index]) T(std::move(components[last]));
+			}
+			SparseSlot(moved.GetId()) = index;
+		}
+		SparseSlot(entity.GetId()) = Tombstone;
+		entities.pop_back();
+		components.pop_back();
+	}
+
+	void EmplaceMoved(Entity entity, void* source) override
+	{
+		Emplace(entity, std::move(*static_cast<T*>(source)));
+	}
+
+	void EmplaceCopied(Entity entity, const void* source) override
+	{
+		if constexpr (std::is_copy_constructible_v<T>)
+		{
+			Emplace(entity, *static_cast<const T*>(source));
+		}
+		else
+		{
+			assert(false && "component type is not copyable");
+		}
+	}
+
+	T* Find(Entity entity)
+	{
+		uint32_t index = Lookup(entity);
+		return index != Tombstone ? &components[index] : nullptr;
+	}
+
+	const T* Find(Entity entity) const
+	{
+		uint32_t index = Lookup(entity);
+		return index != Tombstone ? &components[index] : nullptr;
+	}
+
+	void Reserve(size_t count) override
+	{
+		if (count > entities.capacity())
+		{
+			allocations += 2;
+		}
+		entities.reserve(count);
+		components.reserve(count);
+	}
+
+	void Clear() override
+	{
+		for (Entity entity : entities)
+		{
+			sparse[entity.GetId() / PageSize][entity.GetId() % PageSize] = Tombstone;
+		}
+		entities.clear();
+		components.clear();
+	}
+
+	size_t Size() const override { return entities.size(); }
+	const Entity* GetEntityData() const override { return entities.data(); }
+	const void* GetComponentData() const override { return components.data(); }
+
+	size_t GetReservedBytes() const override
+	{
+		size_t pages = std::count_if(sparse.begin(), sparse.end(), [](const auto& page) { return !page.empty(); });
+		return pages * PageSize * sizeof(uint32_t) + sparse.capacity() * sizeof(sparse[0])
+			+ entities.capacity() * sizeof(Entity) + components.capacity() * sizeof(T);
+	}
+	const EcsVector<Entity>& GetEntities() const { return entities; }
+	EcsVector<T>& GetComponents() { return components; }
+
+	auto begin() { return components.begin(); }
+	auto end() { return components.end(); }
+
+private:
+	static constexpr uint32_t Tombstone = std::numeric_limits<uint32_t>::max();
+
+	// Dense index of entity, or Tombstone. Comparing the stored handle rejects stale
+	// handles whose slot has since been reused.
+	uint32_t Lookup(Entity entity) const
+	{
+		size_t page = entity.GetId() / PageSize;
+		if (page >= sparse.size() || sparse[page].empty())
+		{
+			return Tombstone;
+		}
+		uint32_t index = sparse[page][entity.GetId() % PageSize];
+		return index != Tombstone && entities[index] == entity ? index : Tombstone;
+	}
+
+	uint32_t& SparseSlot(Entity::IdType id)
+	{
+		size_t page = id / PageSize;
+		if (page >= sparse.size())
+		{
+			allocations += page >= sparse.capacity();
+			sparse.resize(page + 1);
+		}
+		if (sparse[page].empty())
+		{
+			++allocations;
+			sparse[page].assign(PageSize, Tombstone);
+		}
+		return sparse[page][id % PageSize];
+	}
+
+	// Empty vectors stand for pages that were never touched.
+	EcsVector<EcsVector<uint32_t>> sparse;
+	EcsVector<Entity> entities;
+	EcsVector<T> components;
+};
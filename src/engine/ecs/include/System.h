@@ -1,17 +1,157 @@
 #pragma once
 
+#include <cstdint>
+#include <span>
 #include <vector>
+#include "ComponentType.h"
 #include "Entity.h"
+#include "../../core/include/MemoryTracker.h"
+#include "SystemGroup.h"
+
+class ECSManager;
 
 class System 
 {
 public:
+  virtual ~System() = default;
   virtual void Update(float deltaTime) = 0;
+  virtual const char* GetName() const { return "System"; }
 
-  void AddEntity(Entity entity) {
-    entities.push_back(entity);
+  // Runs Update with component writes on this thread stamped as version. Called by
+  // the scheduler, which hands every run a fresh version.
+  void Run(float deltaTime, uint32_t version) {
+    uint32_t previous = runningVersion;
+    runningVersion = version;
+    processed = 0;
+    Update(deltaTime);
+    runningVersion = previous;
+    lastRunVersion = version;
+  }
+
+  // Change version of this system's previous run; filter views with
+  // ChangedSince(GetLastRunVersion()) to visit only data written since then.
+  uint32_t GetLastRunVersion() const { return lastRunVersion; }
+
+  // Version of the system running on the calling thread, or 0 outside systems.
+  static uint32_t GetRunningVersion() { return runningVersion; }
+
+  void SetECSManager(ECSManager* manager) {
+    ecsManager = manager;
+  }
+
+  const Signature& GetReads() const { return reads; }
+  const Signature& GetWrites() const { return writes; }
+  bool DeclaresAccess() const { return declaresAccess; }
+  bool RunsOnMainThread() const { return mainThreadOnly; }
+
+  // Live entities owning every component passed to Requires. ECSManager updates the
+  // set once per frame, before systems run, so it excludes changes made during the
+  // current UpdateSystems call.
+  const Signature& GetRequired() const { return required; }
+  const EcsVector<Entity>& GetEntities() const { return entities; }
+
+  SystemGroupId GetGroup() const { return group; }
+
+  // Part of GetEntities this run should process when the system's group is time-sliced,
+  // otherwise all of it. Slices are cut from the current set, so entities joining or
+  // leaving between runs can shift an entity into a neighbouring slice.
+  std::span<const Entity> GetSliceEntities() const {
+    size_t begin = entities.size() * sliceIndex / sliceCount;
+    size_t end = entities.size() * (sliceIndex + 1) / sliceCount;
+    return std::span<const Entity>(entities).subspan(begin, end - begin);
+  }
+  uint32_t GetSliceIndex() const { return sliceIndex; }
+  uint32_t GetSliceCount() const { return sliceCount; }
+
+  // Entities the last run processed for SystemTimings: what it passed to
+  // CountProcessed, or its slice of GetEntities if it reported nothing.
+  size_t GetProcessedCount() const {
+    return processed ? processed : GetSliceEntities().size();
   }
 
 protected:
-  std::vector<Entity> entities;
-};
\ No newline at end of file
+  // Declared component access lets the scheduler run non-conflicting systems in
+  // parallel. Systems that declare nothing are treated as touching everything.
+  template <typename... Ts>
+  void Reads() {
+    (reads.set(ComponentType<Ts>::Get()), ...);
+    declaresAccess = true;
+  }
+
+  template <typename... Ts>
+  void Writes() {
+    (writes.set(ComponentType<Ts>::Get()), ...);
+    declaresAccess = true;
+  }
+
+  // Reports entities handled by this run, for systems that iterate views rather than
+  // GetEntities.
+  void CountProcessed(size_t count) {
+    processed += count;
+  }
+
+  // For systems bound to the main thread, e.g. ones issuing GL calls.
+  void RunOnMainThread() {
+    mainThreadOnly = true;
+  }
+
+  // Components an entity must own to appear in GetEntities. Call from the constructor.
+  template <typename... Ts>
+  void Requires() {
+    (required.set(ComponentType<Ts>::Get()), ...);
+  }
+
+  ECSManager* ecsManager = nullptr;
+
+private:
+  friend class ECSManager;
+
+  static constexpr uint32_t NotMember = UINT32_MAX;
+
+  bool IsMember(Entity entity) const {
+    return entity.GetId() < memberSlots.size() && memberSlots[entity.GetId()] != NotMember
+      && entities[memberSlots[entity.GetId()]] == entity;
+  }
+
+  void AddMember(Entity entity) {
+    if (entity.GetId() >= memberSlots.size()) {
+      memberSlots.resize(entity.GetId() + 1, NotMember);
+    }
+    memberSlots[entity.GetId()] = static_cast<uint32_t>(entities.size());
+    entities.push_back(entity);
+  }
+
+  // Drops whichever entity currently holds index's slot, if any.
+  void RemoveMember(Entity::IdType index) {
+    if (index >= memberSlots.size() || memberSlots[index] == NotMember) {
+      return;
+    }
+    uint32_t slot = memberSlots[index];
+    Entity moved = entities.back();
+    entities[slot] = moved;
+    memberSlots[moved.GetId()] = slot;
+    memberSlots[index] = NotMember;
+    entities.pop_back();
+  }
+
+  void ClearMembers() {
+    entities.clear();
+    memberSlots.clear();
+  }
+
+  EcsVector<Entity> entities;
+  EcsVector<uint32_t> memberSlots;
+  Signature required;
+
+  inline static thread_local uint32_t runningVersion = 0;
+
+  uint32_t lastRunVersion = 0;
+  SystemGroupId group = DefaultSystemGroup;
+  uint32_t sliceIndex = 0;
+  uint32_t sliceCount = 1;
+  size_t processed = 0;
+  Signature reads;
+  Signature writes;
+  bool declaresAccess = false;
+  bool mainThreadOnly = false;
+};
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using SystemGroupId = uint32_t;
+
+// Group every system joins unless given another; runs on every UpdateSystems.
+constexpr SystemGroupId DefaultSystemGroup = 0;
+
+struct SystemGroupSettings
+{
+	// Full passes over the group's entities per second; 0 runs one on every UpdateSystems.
+	float tickRate = 0.0f;
+	// Splits each pass into this many runs on successive ticks, each covering 1 / slices
+	// of every system's entities (System::GetSliceEntities).
+	uint32_t slices = 1;
+	// CPU time the group's systems may take per run, summed; 0 for no budget. A run over
+	// budget doubles the slice count, up to SystemGroups::MaxSlices; runs well under it
+	// halve it again, down to slices.
+	float budgetMilliseconds = 0.0f;
+};
+
+struct SystemGroupStats
+{
+	uint64_t runs = 0;
+	uint64_t overBudgetRuns = 0;
+	uint32_t slices = 1;
+	// Left at 0 unless a group has a budget or system timings are enabled.
+	float lastMilliseconds = 0.0f;
+};
+
+// Decides which groups of systems are due on each UpdateSystems and the time step each
+// one sees. Low-rate groups start at spread out phases so they do not all come due on
+// the same frame, and a group that falls behind skips ahead rather than catching up.
+class SystemGroups
+{
+public:
+	static constexpr uint32_t MaxSlices = 64;
+	// Delta of a group that does not run this tick.
+	static constexpr float NotDue = -1.0f;
+
+	SystemGroups();
+
+	SystemGroupId Add(std::string name, const SystemGroupSettings& settings);
+	size_t GetCount() const { return groups.size(); }
+	const std::string& GetName(SystemGroupId id) const { return groups[id].name; }
+	const SystemGroupSettings& GetSettings(SystemGroupId id) const { return groups[id].settings; }
+	const SystemGroupStats& GetStats(SystemGroupId id) const { return groups[id].stats; }
+	// Whether any group has a CPU budget, and so needs its systems timed.
+	bool HasBudget() const { return budgeted; }
+
+	// Advances time by deltaTime and returns, per group, the delta its systems get this
+	// tick: the time since the same slice last ran, or NotDue.
+	const std::vector<float>& BeginTick(float deltaTime);
+	// Slice run by the group this tick.
+	uint32_t GetSliceIndex(SystemGroupId id) const { return groups[id].slice; }
+	uint32_t GetSliceCount(SystemGroupId id) const { return static_cast<uint32_t>(groups[id].sliceLastRun.size()); }
+	// Records the CPU time a due group's systems took and adapts its slicing to the budget.
+	void EndTick(SystemGroupId id, float milliseconds);
+
+private:
+	struct Group
+	{
+		std::string name;
+		SystemGroupSettings settings;
+		SystemGroupStats stats;
+		double next = 0.0;
+		float lastDelta = 0.0f;
+		uint32_t slice = 0;
+		std::vector<double> sliceLastRun;
+	};
+
+	double GetInterval(const Group& group) const;
+	void SetSliceCount(Group& group, uint32_t count);
+
+	std::vector<Group> groups;
+	std::vector<float> deltas;
+	double time = 0.0;
+	bool budgeted = false;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+#include "System.h"
+#include "SystemTimings.h"
+
+class JobSystem;
+
+// Orders systems into a dependency graph from their declared component access. Two
+// systems conflict when either writes a component the other reads or writes; a
+// conflicting pair keeps its registration order, everything else may overlap.
+class SystemScheduler
+{
+public:
+	void Build(const std::vector<std::shared_ptr<System>>& systems);
+	bool IsBuilt() const { return built; }
+	void Invalidate() { built = false; }
+
+	// Runs every system whose group is due, passing groupDeltas[group] as its delta time;
+	// systems of groups at SystemGroups::NotDue are skipped but keep ordering the rest.
+	// Ready systems become jobs while the calling thread runs main-thread systems and
+	// otherwise helps with jobs; without a job system everything runs on the calling
+	// thread. Each run takes the next value of changeVersion as its write version.
+	// Systems are only timed and their allocations counted when timed is set.
+	void Run(const std::vector<float>& groupDeltas, JobSystem* jobs, std::atomic<uint32_t>& changeVersion, bool timed);
+
+	// Wall time node's system took in the last Run, 0 if it was skipped or not timed.
+	// Nodes are in the order of the systems passed to Build.
+	int64_t GetRunNanoseconds(size_t node) const { return nodes[node].nanoseconds; }
+	// Allocations counted by SystemTimings' allocation counter during the last Run.
+	uint32_t GetRunAllocations(size_t node) const { return nodes[node].allocations; }
+
+	// Prints each stage (systems that can run together) and the edges between them.
+	void Dump(std::ostream& out) const;
+
+private:
+	struct Node
+	{
+		System* system = nullptr;
+		std::vector<size_t> dependents;
+		size_t dependencyCount = 0;
+		size_t stage = 0;
+		SystemGroupId group = DefaultSystemGroup;
+		int64_t nanoseconds = 0;
+		uint32_t allocations = 0;
+	};
+
+	static bool Conflicts(const System& a, const System& b);
+	void Dispatch(size_t node, JobSystem* jobs);
+	void Execute(size_t node, JobSystem* jobs);
+	void Complete(size_t node, JobSystem* jobs);
+
+	std::vector<Node> nodes;
+	bool built = false;
+
+	std::unique_ptr<std::atomic<size_t>[]> remaining;
+	std::atomic<size_t> pending{ 0 };
+	std::atomic<uint32_t>* versions = nullptr;
+	const std::vector<float>* deltas = nullptr;
+	bool timed = false;
+	SystemTimings::AllocationCounter allocationCounter = nullptr;
+	std::mutex mainThreadMutex;
+	std::deque<size_t> mainThreadQueue;
+};
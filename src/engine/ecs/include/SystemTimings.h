@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "SystemGroup.h"
+
+class System;
+
+// Rolling statistics over the samples a system has in its ring.
+struct SystemTimingSummary
+{
+	std::string name;
+	SystemGroupId group = DefaultSystemGroup;
+	size_t samples = 0;
+	double minMilliseconds = 0.0;
+	double averageMilliseconds = 0.0;
+	double p99Milliseconds = 0.0;
+	double maxMilliseconds = 0.0;
+	double averageEntities = 0.0;
+	double averageAllocations = 0.0;
+};
+
+// Per-system record of the last Capacity runs from UpdateSystems: wall time, entities
+// processed and heap allocations. Disabled by default; while disabled UpdateSystems only
+// checks the flag. Each system's ring has a single writer, the thread calling
+// UpdateSystems, and is read without locks; summaries taken while it records may mix in
+// a sample from the next run.
+class SystemTimings
+{
+public:
+	static constexpr size_t Capacity = 256;
+
+	// Returns the number of allocations made so far by the calling thread.
+	using AllocationCounter = uint64_t (*)();
+
+	void SetEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+	bool IsEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+	// Source for the allocation column, shared by every world; zero without one.
+	static void SetAllocationCounter(AllocationCounter counter) { allocationCounter.store(counter, std::memory_order_relaxed); }
+	static AllocationCounter GetAllocationCounter() { return allocationCounter.load(std::memory_order_relaxed); }
+
+	// Maps the scheduler's system order onto rings, keeping those of removed systems
+	// so a shutdown dump still lists them. Called whenever the schedule is rebuilt.
+	void Bind(const std::vector<std::shared_ptr<System>>& systems);
+	void Record(size_t system, uint64_t frame, int64_t nanoseconds, uint32_t entities, uint32_t allocations);
+
+	// One summary per system ever bound, in binding order; call from the thread that
+	// calls UpdateSystems.
+	std::vector<SystemTimingSummary> Summarize() const;
+	void WriteCsv(std::ostream& out) const;
+	void WriteJson(std::ostream& out) const;
+	// Writes JSON if path ends in .json, CSV otherwise.
+	bool Save(const std::string& path) const;
+
+private:
+	struct Slot
+	{
+		std::atomic<uint64_t> frame{ 0 };
+		std::atomic<int64_t> nanoseconds{ 0 };
+		std::atomic<uint32_t> entities{ 0 };
+		std::atomic<uint32_t> allocations{ 0 };
+	};
+
+	struct Track
+	{
+		const System* system = nullptr;
+		std::string name;
+		SystemGroupId group = DefaultSystemGroup;
+		std::array<Slot, Capacity> slots;
+		std::atomic<uint64_t> written{ 0 };
+	};
+
+	std::atomic<bool> enabled{ false };
+	inline static std::atomic<AllocationCounter> allocationCounter{ nullptr };
+	std::vector<std::unique_ptr<Track>> tracks;
+	std::vector<Track*> bound;
+};
@@ -0,0 +1,522 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "Archetype.h"
+#include "Component.h"
+#include "ComponentType.h"
+#include "SparseSet.h"
+#include "../../core/include/JobSystem.h"
+
+// Archetypes matching a component signature. Owned by ECSManager, which appends newly
+// created archetypes as they appear so views never rescan the archetype list.
+struct QueryCache
+{
+	Signature required;
+	EcsVector<Archetype*> archetypes;
+};
+
+// Iterable set of entities owning every component in Ts. Archetype components are read
+// straight from chunk columns; sparse-set components are probed per entity. Visiting a
+// chunk marks its columns for non-const Ts as changed; list a component as const T to
+// read it without doing so. Tags carry no data, so they are not listed in Ts; narrow the
+// view with With and Without instead.
+template <typename... Ts>
+class ComponentView
+{
+	static_assert(sizeof...(Ts) > 0, "a view needs at least one component");
+	static_assert(!(IsSparseComponent<Ts> && ...), "views need an archetype component; iterate GetSparseSet instead");
+	static_assert(!(IsTagComponent<Ts> || ...), "tags have no data; filter on them with With and Without");
+
+	static constexpr size_t MaxTagFilters = 8;
+
+	// Tag types a view requires or excludes.
+	struct TagFilter
+	{
+		std::array<ComponentTypeId, MaxTagFilters> types;
+		size_t count = 0;
+	};
+
+	// A chunk's bits for each filter tag; null where the archetype has no bits for it.
+	struct TagMasks
+	{
+		std::array<const uint64_t*, MaxTagFilters> with;
+		std::array<const uint64_t*, MaxTagFilters> without;
+	};
+
+	template <typename T>
+	using Pool = std::conditional_t<IsSparseComponent<T>, SparseSet<std::remove_const_t<T>>*, std::nullptr_t>;
+
+	template <typename T>
+	static T* Fetch(T* column, Pool<T> pool, Entity entity, uint32_t row)
+	{
+		if constexpr (IsSparseComponent<T>)
+		{
+			return pool ? pool->Find(entity) : nullptr;
+		}
+		else
+		{
+			return column + row;
+		}
+	}
+
+public:
+	using Pools = std::tuple<Pool<Ts>...>;
+
+	class Iterator
+	{
+	public:
+		using value_type = std::tuple<Entity, Ts&...>;
+
+		Iterator(const ComponentView* view, size_t archetype)
+			: view(view), archetype(archetype)
+		{
+			LoadChunk();
+			SkipMissing();
+		}
+
+		value_type operator*() const
+		{
+			return Dereference(std::index_sequence_for<Ts...>());
+		}
+
+		Iterator& operator++()
+		{
+			++row;
+			SkipMissing();
+			return *this;
+		}
+
+		bool operator==(const Iterator& other) const
+		{
+			return archetype == other.archetype && chunk == other.chunk && row == other.row;
+		}
+
+		bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+	private:
+		template <size_t... Is>
+		value_type Dereference(std::index_sequence<Is...>) const
+		{
+			Entity entity = entities[row];
+			return value_type(entity, *Fetch<Ts>(std::get<Is>(columns), std::get<Is>(view->pools), entity, row)...);
+		}
+
+		void LoadChunk()
+		{
+			const auto& archetypes = view->cache->archetypes;
+			while (archetype < archetypes.size())
+			{
+				Archetype* current = archetypes[archetype];
+				if (chunk < current->GetChunkCount())
+				{
+					const Archetype::Chunk& data = current->GetChunk(chunk);
+					TagMasks masks;
+					if (!view->LoadTagMasks(current, chunk, masks) || !view->Visit(current, data, true))
+					{
+						++chunk;
+						continue;
+					}
+					entities = current->GetEntities(data);
+					count = data.count;
+					columns = std::tuple<Ts*...>(ColumnOf<Ts>(current, data)...);
+					return;
+				}
+				++archetype;
+				chunk = 0;
+			}
+			count = 0;
+		}
+
+		void SkipMissing()
+		{
+			while (archetype < view->cache->archetypes.size())
+			{
+				if (row == count)
+				{
+					++chunk;
+					row = 0;
+					LoadChunk();
+					continue;
+				}
+				if (view->HasSparse(entities[row], std::index_sequence_for<Ts...>())
+					&& view->HasTags(view->cache->archetypes[archetype], chunk, row))
+				{
+					return;
+				}
+				++row;
+			}
+			chunk = 0;
+			row = 0;
+		}
+
+		const ComponentView* view;
+		size_t archetype;
+		size_t chunk = 0;
+		uint32_t row = 0;
+		uint32_t count = 0;
+		Entity* entities = nullptr;
+		std::tuple<Ts*...> columns;
+	};
+
+	// Writes through the view are stamped with version (see Archetype change versions).
+	ComponentView(const QueryCache& cache, Pools pools, uint32_t version)
+		: cache(&cache), pools(pools), version(version)
+	{
+	}
+
+	// Same view restricted to chunks where at least one of Us was marked changed after
+	// version since. Filtering is per chunk, so unchanged entities sharing a chunk with
+	// a changed one are still visited.
+	template <typename... Us>
+	ComponentView ChangedSince(uint32_t since) const
+	{
+		static_assert(!(IsSparseComponent<Us> || ...), "change filters need archetype components");
+		ComponentView view = *this;
+		view.changedFilter = MakeSignature<Us...>();
+		view.changedSince = since;
+		return view;
+	}
+
+	// Same view restricted to entities tagged with every one of Us. The filter is applied
+	// 64 rows at a time by combining the chunk's tag bit words.
+	template <typename... Us>
+	ComponentView With() const
+	{
+		static_assert((IsTagComponent<Us> && ...), "With filters on tag components");
+		ComponentView view = *this;
+		(view.AddTagFilter(view.withTags, ComponentType<Us>::Get()), ...);
+		return view;
+	}
+
+	// Same view restricted to entities tagged with none of Us.
+	template <typename... Us>
+	ComponentView Without() const
+	{
+		static_assert((IsTagComponent<Us> && ...), "Without filters on tag components");
+		ComponentView view = *this;
+		(view.AddTagFilter(view.withoutTags, ComponentType<Us>::Get()), ...);
+		return view;
+	}
+
+	// Archetypes holding every archetype component in Ts, ignoring the view's filters.
+	// The list grows as matching archetypes are created.
+	const EcsVector<Archetype*>& GetArchetypes() const { return cache->archetypes; }
+
+	Iterator begin() const { return Iterator(this, 0); }
+	Iterator end() const { return Iterator(this, cache->archetypes.size()); }
+
+	// Calls func(Entity, Ts&...) chunk by chunk; faster than range-for since column
+	// pointers are resolved once per chunk.
+	template <typename Func>
+	void Each(Func&& func) const
+	{
+		for (Archetype* archetype : cache->archetypes)
+		{
+			for (size_t c = 0; c < archetype->GetChunkCount(); ++c)
+			{
+				ProcessChunk(func, archetype, c);
+			}
+		}
+	}
+
+	// Each with whole chunks handed out to jobs's threads; returns once every entity has
+	// been visited. func runs concurrently, so it may only write the components it is
+	// passed. Index per-thread scratch with JobSystem::GetThreadIndex (see PerThread).
+	template <typename Func>
+	void ParallelForEach(JobSystem& jobs, Func&& func) const
+	{
+		jobs.ParallelFor(GetChunkCount(), [&](size_t begin, size_t end)
+		{
+			ForChunks(begin, end, [&](Archetype* archetype, size_t chunk, size_t)
+			{
+				ProcessChunk(func, archetype, chunk);
+			});
+		});
+	}
+
+	// Folds every entity into one value in parallel. Each chunk starts from identity and
+	// is folded with accumulate(T&, Entity, Ts&...); the per-chunk results are then merged
+	// in query order with combine(T&, const T&) on the calling thread. The split depends
+	// only on the chunk layout, never on the thread count or timing, so floating-point
+	// results are reproducible.
+	template <typename T, typename Accumulate, typename Combine>
+	T ParallelReduce(JobSystem& jobs, T identity, Accumulate&& accumulate, Combine&& combine) const
+	{
+		std::vector<T> partials(GetChunkCount(), identity);
+		jobs.ParallelFor(partials.size(), [&](size_t begin, size_t end)
+		{
+			ForChunks(begin, end, [&](Archetype* archetype, size_t chunk, size_t index)
+			{
+				T local = identity;
+				auto fold = [&](Entity entity, Ts&... components) { accumulate(local, entity, components...); };
+				ProcessChunk(fold, archetype, chunk);
+				partials[index] = std::move(local);
+			});
+		});
+		for (const T& partial : partials)
+		{
+			combine(identity, partial);
+		}
+		return identity;
+	}
+
+	// Number of matching entities. Does not mark anything changed.
+	size_t Count() const
+	{
+		size_t count = 0;
+		for (Archetype* archetype : cache->archetypes)
+		{
+			if constexpr (!(IsSparseComponent<Ts> || ...))
+			{
+				if (changedFilter.none() && !HasTagFilter())
+				{
+					count += archetype->GetEntityCount();
+					continue;
+				}
+			}
+			for (size_t c = 0; c < archetype->GetChunkCount(); ++c)
+			{
+				const Archetype::Chunk& chunk = archetype->GetChunk(c);
+				TagMasks masks;
+				if (!LoadTagMasks(archetype, c, masks) || !Visit(archetype, chunk, false))
+				{
+					continue;
+				}
+				if constexpr ((IsSparseComponent<Ts> || ...))
+				{
+					Entity* entities = archetype->GetEntities(chunk);
+					for (uint32_t row = 0; row < chunk.count; ++row)
+					{
+						count += HasSparse(entities[row], std::index_sequence_for<Ts...>()) && HasTags(archetype, c, row);
+					}
+				}
+				else if (HasTagFilter())
+				{
+					for (uint32_t word = 0; word * 64 < chunk.count; ++word)
+					{
+						count += std::popcount(RowMask(masks, word, chunk.count));
+					}
+				}
+				else
+				{
+					count += chunk.count;
+				}
+			}
+		}
+		return count;
+	}
+
+private:
+	// False if the change filter rejects chunk. Otherwise, when write is set, marks the
+	// chunk's columns for non-const archetype components as changed.
+	bool Visit(Archetype* archetype, const Archetype::Chunk& chunk, bool write) const
+	{
+		if (changedFilter.any())
+		{
+			const EcsVector<ComponentTypeId>& types = archetype->GetTypes();
+			const uint32_t* versions = archetype->GetVersions(chunk);
+			bool changed = false;
+			for (size_t column = 0; column < types.size() && !changed; ++column)
+			{
+				changed = changedFilter.test(types[column]) && versions[column] > changedSince;
+			}
+			if (!changed)
+			{
+				return false;
+			}
+		}
+		if (write)
+		{
+			(MarkWritten<Ts>(archetype, chunk), ...);
+		}
+		return true;
+	}
+
+	template <typename T>
+	void MarkWritten(Archetype* archetype, const Archetype::Chunk& chunk) const
+	{
+		if constexpr (!std::is_const_v<T> && !IsSparseComponent<T>)
+		{
+			archetype->MarkChanged(chunk, archetype->FindColumn(ComponentType<T>::Get()), version);
+		}
+	}
+
+	void AddTagFilter(TagFilter& filter, ComponentTypeId tag)
+	{
+		assert(filter.count < MaxTagFilters && "raise MaxTagFilters");
+		filter.types[filter.count++] = tag;
+	}
+
+	bool HasTagFilter() const { return withTags.count + withoutTags.count > 0; }
+
+	// False if no row of the chunk can pass the With filter.
+	bool LoadTagMasks(const Archetype* archetype, size_t chunk, TagMasks& masks) const
+	{
+		for (size_t i = 0; i < withTags.count; ++i)
+		{
+			masks.with[i] = archetype->GetTagBits(withTags.types[i], chunk);
+			if (!masks.with[i])
+			{
+				return false;
+			}
+		}
+		for (size_t i = 0; i < withoutTags.count; ++i)
+		{
+			masks.without[i] = archetype->GetTagBits(withoutTags.types[i], chunk);
+		}
+		return true;
+	}
+
+	// Rows word * 64 to word * 64 + 63 of a chunk holding count rows that pass the tag
+	// filters, one bit per row.
+	uint64_t RowMask(const TagMasks& masks, uint32_t word, uint32_t count) const
+	{
+		const uint32_t remaining = count - word * 64;
+		uint64_t rows = remaining >= 64 ? ~uint64_t(0) : (uint64_t(1) << remaining) - 1;
+		for (size_t i = 0; i < withTags.count; ++i)
+		{
+			rows &= masks.with[i][word];
+		}
+		for (size_t i = 0; i < withoutTags.count; ++i)
+		{
+			rows &= masks.without[i] ? ~masks.without[i][word] : ~uint64_t(0);
+		}
+		return rows;
+	}
+
+	bool HasTags(const Archetype* archetype, size_t chunk, uint32_t row) const
+	{
+		for (size_t i = 0; i < withTags.count; ++i)
+		{
+			if (!archetype->HasTag(withTags.types[i], static_cast<uint32_t>(chunk), row))
+			{
+				return false;
+			}
+		}
+		for (size_t i = 0; i < withoutTags.count; ++i)
+		{
+			if (archetype->HasTag(withoutTags.types[i], static_cast<uint32_t>(chunk), row))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template <size_t... Is>
+	bool HasSparse(Entity entity, std::index_sequence<Is...>) const
+	{
+		return ((!IsSparseComponent<Ts> || Fetch<Ts>(nullptr, std::get<Is>(pools), entity, 0)) && ...);
+	}
+
+	template <typename T>
+	static T* ColumnOf(Archetype* archetype, const Archetype::Chunk& chunk)
+	{
+		if constexpr (IsSparseComponent<T>)
+		{
+			return nullptr;
+		}
+		else
+		{
+			return archetype->GetColumn<std::remove_const_t<T>>(chunk, archetype->FindColumn(ComponentType<T>::Get()));
+		}
+	}
+
+	size_t GetChunkCount() const
+	{
+		size_t count = 0;
+		for (Archetype* archetype : cache->archetypes)
+		{
+			count += archetype->GetChunkCount();
+		}
+		return count;
+	}
+
+	// Calls func(archetype, chunk, index) for chunks begin to end, numbered across the
+	// query's archetypes in order.
+	template <typename Func>
+	void ForChunks(size_t begin, size_t end, Func&& func) const
+	{
+		size_t first = 0;
+		for (Archetype* archetype : cache->archetypes)
+		{
+			const size_t count = archetype->GetChunkCount();
+			for (size_t chunk = begin > first ? begin - first : 0; chunk < count && first + chunk < end; ++chunk)
+			{
+				func(archetype, chunk, first + chunk);
+			}
+			first += count;
+			if (first >= end)
+			{
+				return;
+			}
+		}
+	}
+
+	template <typename Func>
+	void ProcessChunk(Func& func, Archetype* archetype, size_t c) const
+	{
+		const Archetype::Chunk& chunk = archetype->GetChunk(c);
+		TagMasks masks;
+		if (!LoadTagMasks(archetype, c, masks) || !Visit(archetype, chunk, true))
+		{
+			return;
+		}
+		Entity* entities = archetype->GetEntities(chunk);
+		std::tuple<Ts*...> columns(ColumnOf<Ts>(archetype, chunk)...);
+		if (!HasTagFilter())
+		{
+			EachInChunk(func, entities, chunk.count, columns, std::index_sequence_for<Ts...>());
+			return;
+		}
+		for (uint32_t word = 0; word * 64 < chunk.count; ++word)
+		{
+			for (uint64_t rows = RowMask(masks, word, chunk.count); rows; rows &= rows - 1)
+			{
+				EachRow(func, entities, word * 64 + std::countr_zero(rows), columns, std::index_sequence_for<Ts...>());
+			}
+		}
+	}
+
+	template <typename Func, size_t... Is>
+	void EachInChunk(Func& func, Entity* entities, uint32_t count, const std::tuple<Ts*...>& columns, std::index_sequence<Is...>) const
+	{
+		for (uint32_t row = 0; row < count; ++row)
+		{
+			EachRow(func, entities, row, columns, std::index_sequence<Is...>());
+		}
+	}
+
+	template <typename Func, size_t... Is>
+	void EachRow(Func& func, Entity* entities, uint32_t row, const std::tuple<Ts*...>& columns, std::index_sequence<Is...>) const
+	{
+		Entity entity = entities[row];
+		if constexpr ((IsSparseComponent<Ts> || ...))
+		{
+			std::tuple<Ts*...> components(Fetch<Ts>(std::get<Is>(columns), std::get<Is>(pools), entity, row)...);
+			if (((std::get<Is>(components) != nullptr) && ...))
+			{
+				func(entity, *std::get<Is>(components)...);
+			}
+		}
+		else
+		{
+			func(entity, std::get<Is>(columns)[row]...);
+		}
+	}
+
+	const QueryCache* cache;
+	Pools pools;
+	uint32_t version;
+	Signature changedFilter;
+	uint32_t changedSince = 0;
+	TagFilter withTags;
+	TagFilter withoutTags;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+class ECSManager;
+
+// Binary save and load of a whole ECSManager: entity slots with their generations, the
+// free list, every archetype's rows, every sparse-set pool and the entities carrying
+// each tag. Entity handles are kept exactly, so components that refer to other entities
+// stay valid after a load.
+//
+// Sections are addressed by file offset and each component column is stored as one
+// contiguous, 64-byte aligned array, so loading maps the file and copies columns
+// straight into chunks. Types are matched by name and only components declared
+// Persistent are stored (see ComponentPersistence); Save fails if the world holds a
+// component that declares neither way. Columns whose type is unknown or changed size
+// are dropped on load.
+// Padding is zeroed and sections are sorted by type name, so saving an unchanged world
+// twice yields identical files.
+class WorldSnapshot
+{
+public:
+	static constexpr uint32_t FormatVersion = 1;
+
+	static bool Save(const ECSManager& world, const std::string& path);
+
+	// Replaces everything in world with the snapshot's contents.
+	static bool Load(ECSManager& world, const std::string& path);
+
+	// Reports entities added and removed between two snapshots, and per component type
+	// how many entities gained, lost or changed a value.
+	static bool Diff(const std::string& before, const std::string& after, std::ostream& out);
+};
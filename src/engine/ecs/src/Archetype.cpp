@@ -0,0 +1,239 @@
+#include "../include/Archetype.h"
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+	size_t AlignUp(size_t value, size_t alignment)
+	{
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+}
+
+Archetype::Archetype(const Signature& signature, ChunkPool& pool)
+	: pool(&pool), signature(signature)
+{
+	columnIndex.fill(-1);
+	size_t rowSize = sizeof(Entity);
+	for (ComponentTypeId type = 0; type < MaxComponentTypes; ++type)
+	{
+		if (signature.test(type))
+		{
+			columnIndex[type] = static_cast<int>(types.size());
+			types.push_back(type);
+			components.push_back(ComponentRegistry::GetInfo(type));
+			rowSize += components.back().size;
+			if (components.back().alignment > ChunkPool::ChunkAlignment)
+			{
+				std::cerr << "Component " << components.back().name << " is aligned beyond the chunk alignment" << std::endl;
+				std::abort();
+			}
+		}
+	}
+
+	// Start from the unpadded estimate and shrink until every aligned column fits.
+	entitiesOffset = AlignUp(components.size() * sizeof(uint32_t), alignof(Entity));
+	size_t capacity = std::max<size_t>((ChunkSize - entitiesOffset) / rowSize, 1);
+	columnOffsets.resize(components.size());
+	for (;; --capacity)
+	{
+		size_t offset = entitiesOffset + sizeof(Entity) * capacity;
+		for (size_t i = 0; i < components.size(); ++i)
+		{
+			offset = AlignUp(offset, components[i].alignment);
+			columnOffsets[i] = offset;
+			offset += components[i].size * capacity;
+		}
+		if (offset <= ChunkSize)
+		{
+			break;
+		}
+		if (capacity == 1)
+		{
+			// Each type fits on its own, but together they overflow a chunk.
+			std::cerr << "Archetype row of " << offset << " bytes does not fit in a " << ChunkSize << " byte chunk:";
+			for (const ComponentInfo& info : components)
+			{
+				std::cerr << ' ' << info.name;
+			}
+			std::cerr << std::endl;
+			std::abort();
+		}
+	}
+	chunkCapacity = static_cast<uint32_t>(capacity);
+	tagWords = (chunkCapacity + 63) / 64;
+}
+
+Archetype::~Archetype()
+{
+	for (auto& chunk : chunks)
+	{
+		for (size_t column = 0; column < components.size(); ++column)
+		{
+			for (uint32_t row = 0; row < chunk.count; ++row)
+			{
+				components[column].destroy(chunk.data + columnOffsets[column] + row * components[column].size);
+			}
+		}
+		pool->Free(chunk.data);
+	}
+}
+
+Archetype::RowRange Archetype::AllocateRows(size_t count, uint32_t version)
+{
+	if (chunks.empty() || chunks.back().count == chunkCapacity)
+	{
+		Chunk chunk;
+		chunk.data = pool->Allocate();
+		chunks.push_back(chunk);
+		++chunkCheckouts;
+		for (ComponentTypeId tag : tagTypes)
+		{
+			tagBits[tag].resize(chunks.size() * tagWords, 0);
+		}
+	}
+
+	++layoutVersion;
+	Chunk& chunk = chunks.back();
+	RowRange range;
+	range.chunk = static_cast<uint32_t>(chunks.size() - 1);
+	range.first = chunk.count;
+	range.count = static_cast<uint32_t>(std::min<size_t>(count, chunkCapacity - chunk.count));
+	chunk.count += range.count;
+	entityCount += range.count;
+	MarkAllChanged(chunk, version);
+	return range;
+}
+
+void Archetype::SetChunkCounts(const uint32_t* counts, size_t chunkCount)
+{
+	++layoutVersion;
+	while (chunks.size() > chunkCount)
+	{
+		pool->Free(chunks.back().data);
+		chunks.pop_back();
+	}
+	while (chunks.size() < chunkCount)
+	{
+		Chunk chunk;
+		chunk.data = pool->Allocate();
+		chunks.push_back(chunk);
+		++chunkCheckouts;
+	}
+	entityCount = 0;
+	for (size_t i = 0; i < chunkCount; ++i)
+	{
+		chunks[i].count = counts[i];
+		entityCount += counts[i];
+	}
+	for (ComponentTypeId tag : tagTypes)
+	{
+		tagBits[tag].assign(chunks.size() * tagWords, 0);
+	}
+}
+
+std::pair<uint32_t, uint32_t> Archetype::AllocateRow(Entity entity, uint32_t version)
+{
+	RowRange range = AllocateRows(1, version);
+	new (GetEntities(chunks[range.chunk]) + range.first) Entity(entity);
+	return { range.chunk, range.first };
+}
+
+void Archetype::RemoveRow(uint32_t chunkIndex, uint32_t row, uint32_t version)
+{
+	++layoutVersion;
+	Chunk& last = chunks.back();
+	uint32_t lastRow = last.count - 1;
+	Chunk& chunk = chunks[chunkIndex];
+
+	if (&chunk != &last || row != lastRow)
+	{
+		GetEntities(chunk)[row] = GetEntities(last)[lastRow];
+		for (size_t column = 0; column < components.size(); ++column)
+		{
+			auto& info = components[column];
+			void* dst = chunk.data + columnOffsets[column] + row * info.size;
+			void* src = last.data + columnOffsets[column] + lastRow * info.size;
+			info.moveConstruct(dst, src);
+			info.destroy(src);
+		}
+		MarkAllChanged(chunk, version);
+	}
+
+	// Tag bits follow the moved row; the vacated last row is left clear.
+	const size_t lastBit = (chunks.size() - 1) * tagWords * 64 + lastRow;
+	const size_t holeBit = chunkIndex * tagWords * 64 + row;
+	for (ComponentTypeId tag : tagTypes)
+	{
+		uint64_t* bits = tagBits[tag].data();
+		const uint64_t moved = bits[lastBit / 64] >> (lastBit % 64) & 1;
+		bits[lastBit / 64] &= ~(uint64_t(1) << (lastBit % 64));
+		if (holeBit != lastBit)
+		{
+			bits[holeBit / 64] = (bits[holeBit / 64] & ~(uint64_t(1) << (holeBit % 64))) | moved << (holeBit % 64);
+		}
+	}
+
+	--last.count;
+	--entityCount;
+	if (last.count == 0)
+	{
+		pool->Free(last.data);
+		chunks.pop_back();
+		for (ComponentTypeId tag : tagTypes)
+		{
+			tagBits[tag].resize(chunks.size() * tagWords);
+		}
+	}
+}
+
+EcsVector<uint64_t>& Archetype::GetTagStorage(ComponentTypeId tag)
+{
+	if (!tagged.test(tag))
+	{
+		tagged.set(tag);
+		tagTypes.push_back(tag);
+		tagBits[tag].resize(chunks.size() * tagWords, 0);
+	}
+	return tagBits[tag];
+}
+
+void Archetype::SetTag(ComponentTypeId tag, uint32_t chunk, uint32_t row, bool value)
+{
+	if (!value && !tagged.test(tag))
+	{
+		return;
+	}
+	uint64_t& word = GetTagStorage(tag)[chunk * tagWords + row / 64];
+	const uint64_t bit = uint64_t(1) << (row % 64);
+	word = value ? word | bit : word & ~bit;
+}
+
+void Archetype::SetTagRange(ComponentTypeId tag, uint32_t chunk, uint32_t first, uint32_t count)
+{
+	uint64_t* bits = GetTagStorage(tag).data() + chunk * tagWords;
+	for (uint32_t row = first, end = first + count; row < end;)
+	{
+		const uint32_t shift = row % 64;
+		const uint32_t span = std::min<uint32_t>(64 - shift, end - row);
+		bits[row / 64] |= (span == 64 ? ~uint64_t(0) : (uint64_t(1) << span) - 1) << shift;
+		row += span;
+	}
+}
+
+size_t Archetype::GetTagCount(ComponentTypeId tag) const
+{
+	size_t count = 0;
+	for (uint64_t word : tagBits[tag])
+	{
+		count += std::popcount(word);
+	}
+	return count;
+}
+
+void Archetype::MarkAllChanged(const Chunk& chunk, uint32_t version) const
+{
+	std::fill_n(GetVersions(chunk), components.size(), version);
+}
@@ -0,0 +1,43 @@
+#include "../include/ChunkPool.h"
+#include "../../core/include/MemoryTracker.h"
+#include <cassert>
+
+ChunkPool::~ChunkPool()
+{
+	assert(stats.chunksInUse == 0 && "chunk pool destroyed while archetypes still own chunks");
+	Trim();
+}
+
+std::byte* ChunkPool::Allocate()
+{
+	++stats.chunksInUse;
+	if (freeList)
+	{
+		FreeChunk* chunk = freeList;
+		freeList = chunk->next;
+		--stats.chunksPooled;
+		return reinterpret_cast<std::byte*>(chunk);
+	}
+
+	++stats.systemAllocations;
+	return static_cast<std::byte*>(MemoryTracker::Allocate(ChunkSize, ChunkAlignment, MemoryTag::ECS));
+}
+
+void ChunkPool::Free(std::byte* chunk)
+{
+	--stats.chunksInUse;
+	++stats.chunksPooled;
+	freeList = new (chunk) FreeChunk{ freeList };
+}
+
+void ChunkPool::Trim()
+{
+	while (freeList)
+	{
+		FreeChunk* chunk = freeList;
+		freeList = chunk->next;
+		MemoryTracker::Free(chunk, ChunkSize, ChunkAlignment, MemoryTag::ECS);
+		++stats.systemFrees;
+	}
+	stats.chunksPooled = 0;
+}
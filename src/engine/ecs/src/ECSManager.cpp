@@ -1,50 +1,764 @@
 #include "../include/ECSManager.h"
+#include "../../core/include/Profiler.h"
+#include <cstring>
 
-Entity ECSManager::CreateEntity()
+ECSManager::ECSManager()
+	: workerCount(std::max(std::thread::hardware_concurrency(), 1u) - 1)
 {
-	return Entity(nextEntityId++);
+	emptyArchetype = GetOrCreateArchetype(Signature());
 }
 
-void ECSManager::DestroyEntity(Entity entity)
+Entity::IdType ECSManager::AllocateIndex()
 {
-	components.erase(entity.GetId());
+	if (!freeIndices.empty())
+	{
+		Entity::IdType index = freeIndices.back();
+		freeIndices.pop_back();
+		return index;
+	}
+	Entity::IdType index = static_cast<Entity::IdType>(entityRecords.size());
+	assert(index <= Entity::IndexMask && "entity index space exhausted");
+	entityRecords.emplace_back();
+	return index;
 }
 
-template <typename T, typename... Args>
-void ECSManager::AddComponent(Entity entity, Args&&... args)
+Entity ECSManager::CreateEntity()
 {
-	auto component = std::make_shared<T>(std::forward<Args>(args)...);
-	components[entity.GetId()].push_back(component);
+	Entity::IdType index = AllocateIndex();
+	EntityRecord& record = entityRecords[index];
+	Entity entity(index, record.generation);
+	auto [chunk, row] = emptyArchetype->AllocateRow(entity, GetChangeVersion());
+	record.archetype = emptyArchetype;
+	record.chunk = chunk;
+	record.row = row;
+	MarkDirty(index);
+	return entity;
 }
 
-template <typename T>
-T* ECSManager::GetComponent(Entity entity)
+std::span<const Entity> ECSManager::Instantiate(const Prefab& prefab, size_t count)
 {
-	auto& entityComponents = components[entity.GetId()];
-	for (auto& comp : entityComponents)
+	instantiated.clear();
+	instantiated.reserve(count);
+	if (count > freeIndices.size())
+	{
+		entityRecords.reserve(entityRecords.size() + count - freeIndices.size());
+	}
+
+	Signature archetypeSignature;
+	Signature tags;
+	EcsVector<const Prefab::Value*>& sparseValues = prefabSparseValues;
+	sparseValues.clear();
+	for (const Prefab::Value& value : prefab.GetValues())
+	{
+		const ComponentInfo& info = ComponentRegistry::GetInfo(value.type);
+		if (info.createSparseSet)
+		{
+			sparseValues.push_back(&value);
+		}
+		else if (info.tag)
+		{
+			tags.set(value.type);
+		}
+		else
+		{
+			archetypeSignature.set(value.type);
+		}
+	}
+
+	// Fill the archetype a chunk at a time: entity handles first, then each column from
+	// the prefab value, with memcpy for trivially copyable components.
+	Archetype* archetype = GetOrCreateArchetype(archetypeSignature);
+	const uint32_t version = GetChangeVersion();
+	const auto& components = archetype->GetComponents();
+	const bool markDirty = !membershipStale && !matchingSystems.empty();
+	while (instantiated.size() < count)
+	{
+		Archetype::RowRange rows = archetype->AllocateRows(count - instantiated.size(), version);
+		const Archetype::Chunk& chunk = archetype->GetChunk(rows.chunk);
+		Entity* entities = archetype->GetEntities(chunk) + rows.first;
+
+		// Indices for the whole range at once: the free list is consumed from the back, in
+		// the order AllocateIndex would take it, then fresh records are appended.
+		const size_t reused = std::min<size_t>(rows.count, freeIndices.size());
+		const size_t freeEnd = freeIndices.size();
+		const size_t firstFresh = entityRecords.size();
+		assert(firstFresh + (rows.count - reused) <= size_t(Entity::IndexMask) + 1 && "entity index space exhausted");
+		entityRecords.resize(firstFresh + rows.count - reused);
+		if (markDirty)
+		{
+			dirtyEntities.reserve(dirtyEntities.size() + rows.count);
+		}
+
+		for (uint32_t i = 0; i < rows.count; ++i)
+		{
+			const Entity::IdType index = i < reused
+				? freeIndices[freeEnd - 1 - i]
+				: static_cast<Entity::IdType>(firstFresh + i - reused);
+			EntityRecord& record = entityRecords[index];
+			const Entity entity(index, record.generation);
+			new (entities + i) Entity(entity);
+			instantiated.push_back(entity);
+			record.archetype = archetype;
+			record.chunk = rows.chunk;
+			record.row = rows.first + i;
+			if (markDirty && !record.dirty)
+			{
+				record.dirty = true;
+				dirtyEntities.push_back(index);
+			}
+		}
+		freeIndices.resize(freeEnd - reused);
+
+		for (const Prefab::Value& value : prefab.GetValues())
+		{
+			if (tags.test(value.type))
+			{
+				archetype->SetTagRange(value.type, rows.chunk, rows.first, rows.count);
+				continue;
+			}
+			int column = archetype->FindColumn(value.type);
+			if (column < 0)
+			{
+				continue;
+			}
+			const ComponentInfo& info = components[column];
+			std::byte* destination = static_cast<std::byte*>(archetype->GetColumn(chunk, column)) + rows.first * info.size;
+			if (info.trivial)
+			{
+				// Copy one value, then keep doubling the filled prefix.
+				std::memcpy(destination, value.data, info.size);
+				for (size_t filled = 1; filled < rows.count; filled *= 2)
+				{
+					std::memcpy(destination + filled * info.size, destination, std::min<size_t>(filled, rows.count - filled) * info.size);
+				}
+				continue;
+			}
+			for (uint32_t i = 0; i < rows.count; ++i, destination += info.size)
+			{
+				info.copyConstruct(destination, value.data);
+			}
+		}
+	}
+
+	for (const Prefab::Value* value : sparseValues)
 	{
-		if (T* casted = dynamic_cast<T*>(comp.get()))
+		auto& pool = sparseSets[value->type];
+		if (!pool)
+		{
+			pool.reset(ComponentRegistry::GetInfo(value->type).createSparseSet());
+		}
+		pool->Reserve(pool->Size() + count);
+		for (Entity entity : instantiated)
 		{
-			return casted;
+			pool->EmplaceCopied(entity, value->data);
 		}
 	}
-	return nullptr;
+	return instantiated;
 }
 
-void ECSManager::AddSystem(std::shared_ptr<System> system)
+void ECSManager::DestroyEntity(Entity entity)
 {
+	const EntityRecord* found = FindRecord(entity);
+	if (!found)
+	{
+		return;
+	}
+
+	EntityRecord& record = entityRecords[entity.GetId()];
+	Archetype* archetype = record.archetype;
+	for (size_t column = 0; column < archetype->GetComponents().size(); ++column)
+	{
+		archetype->GetComponents()[column].destroy(archetype->GetComponent(record.chunk, record.row, column));
+	}
+	RemoveRow(archetype, record.chunk, record.row);
+	record.archetype = nullptr;
+	record.generation = static_cast<Entity::GenerationType>((record.generation + 1) & Entity::GenerationMask);
+	if (record.generation == Entity::ProvisionalGeneration)
+	{
+		record.generation = 0;
+	}
+	freeIndices.push_back(entity.GetId());
+	MarkDirty(entity.GetId());
+
+	for (auto& pool : sparseSets)
+	{
+		if (pool)
+		{
+			pool->Remove(entity);
+		}
+	}
+}
+
+void ECSManager::AddSystem(std::shared_ptr<System> system, SystemGroupId group)
+{
+	assert(group < systemGroups.GetCount() && "unknown system group");
+	system->SetECSManager(this);
+	system->group = group;
 	systems.push_back(system);
+	scheduler.Invalidate();
+	membershipStale = true;
 }
 
 std::vector<std::shared_ptr<System>>& ECSManager::GetSystems() 
 {
+	// Callers may reorder or replace systems through the returned reference.
+	scheduler.Invalidate();
+	membershipStale = true;
 	return systems;
 }
 
+SystemGroupId ECSManager::AddSystemGroup(std::string name, const SystemGroupSettings& settings)
+{
+	return systemGroups.Add(std::move(name), settings);
+}
+
 void ECSManager::UpdateSystems(float deltaTime)
 {
+	PROFILE_ZONE("ECSManager::UpdateSystems");
+	if (!scheduler.IsBuilt())
+	{
+		scheduler.Build(systems);
+		systemTimings.Bind(systems);
+	}
+	RefreshSystemEntities();
+
+	const std::vector<float>& groupDeltas = systemGroups.BeginTick(deltaTime);
 	for (auto& system : systems)
 	{
-		system->Update(deltaTime);
+		system->sliceIndex = systemGroups.GetSliceIndex(system->group);
+		system->sliceCount = systemGroups.GetSliceCount(system->group);
+	}
+	// Systems are only timed when something reads the result.
+	const bool recording = systemTimings.IsEnabled();
+	scheduler.Run(groupDeltas, &GetJobSystem(), changeVersion, recording || systemGroups.HasBudget());
+
+	groupMilliseconds.assign(systemGroups.GetCount(), 0.0f);
+	for (size_t i = 0; i < systems.size(); ++i)
+	{
+		groupMilliseconds[systems[i]->group] += static_cast<float>(scheduler.GetRunNanoseconds(i)) * 1e-6f;
+	}
+	for (SystemGroupId group = 0; group < systemGroups.GetCount(); ++group)
+	{
+		if (groupDeltas[group] != SystemGroups::NotDue)
+		{
+			systemGroups.EndTick(group, groupMilliseconds[group]);
+		}
+	}
+	if (recording)
+	{
+		for (size_t i = 0; i < systems.size(); ++i)
+		{
+			if (groupDeltas[systems[i]->group] != SystemGroups::NotDue)
+			{
+				systemTimings.Record(i, updateCount, scheduler.GetRunNanoseconds(i),
+					static_cast<uint32_t>(systems[i]->GetProcessedCount()), scheduler.GetRunAllocations(i));
+			}
+		}
+	}
+	++updateCount;
+
+	// Playback and anything done between frames is stamped after every system's run.
+	++changeVersion;
+	PlaybackCommandBuffers();
+}
+
+void ECSManager::RefreshSystemEntities()
+{
+	PROFILE_ZONE("ECSManager::RefreshSystemEntities");
+	if (membershipStale)
+	{
+		// The system list changed; rebuild every set from scratch.
+		matchingSystems.clear();
+		for (auto& system : systems)
+		{
+			if (system->GetRequired().any())
+			{
+				system->ClearMembers();
+				matchingSystems.push_back(system.get());
+			}
+		}
+		for (Entity::IdType index = 0; index < entityRecords.size(); ++index)
+		{
+			const EntityRecord& record = entityRecords[index];
+			if (!record.archetype)
+			{
+				continue;
+			}
+			Entity entity(index, record.generation);
+			for (System* system : matchingSystems)
+			{
+				if (Matches(record, entity, system->GetRequired()))
+				{
+					system->AddMember(entity);
+				}
+			}
+		}
+		for (Entity::IdType index : dirtyEntities)
+		{
+			entityRecords[index].dirty = false;
+		}
+		dirtyEntities.clear();
+		membershipStale = false;
+		return;
+	}
+
+	for (Entity::IdType index : dirtyEntities)
+	{
+		EntityRecord& record = entityRecords[index];
+		record.dirty = false;
+		Entity entity(index, record.generation);
+		for (System* system : matchingSystems)
+		{
+			bool match = record.archetype && Matches(record, entity, system->GetRequired());
+			if (system->IsMember(entity))
+			{
+				if (!match)
+				{
+					system->RemoveMember(index);
+				}
+				continue;
+			}
+			// The slot may still hold a destroyed entity that shared this index.
+			system->RemoveMember(index);
+			if (match)
+			{
+				system->AddMember(entity);
+			}
+		}
+	}
+	dirtyEntities.clear();
+}
+
+void ECSManager::SetJobSystem(JobSystem* shared)
+{
+	jobSystem = shared;
+	ownedJobSystem.reset();
+	ResizeCommandBuffers(shared ? shared->GetThreadCount() : 0);
+}
+
+void ECSManager::SetWorkerCount(size_t count)
+{
+	workerCount = count;
+	jobSystem = nullptr;
+	ownedJobSystem.reset();
+}
+
+JobSystem& ECSManager::GetJobSystem()
+{
+	if (!jobSystem)
+	{
+		ownedJobSystem = std::make_unique<JobSystem>(workerCount);
+		jobSystem = ownedJobSystem.get();
+		ResizeCommandBuffers(jobSystem->GetThreadCount());
+	}
+	return *jobSystem;
+}
+
+EntityCommandBuffer& ECSManager::GetCommandBuffer()
+{
+	int threadIndex = GetJobSystem().GetThreadIndex();
+	if (threadIndex >= 0)
+	{
+		return *threadCommandBuffers[threadIndex];
+	}
+
+	std::lock_guard<std::mutex> lock(foreignCommandBufferMutex);
+	auto& buffer = foreignCommandBuffers[std::this_thread::get_id()];
+	if (!buffer)
+	{
+		buffer = std::make_unique<EntityCommandBuffer>();
+	}
+	return *buffer;
+}
+
+void ECSManager::PlaybackCommandBuffers()
+{
+	PROFILE_ZONE("ECSManager::PlaybackCommandBuffers");
+	// Scratch vectors are members so playback stops allocating once they have grown.
+	EcsVector<EntityCommandBuffer*>& buffers = playbackBuffers;
+	buffers.clear();
+	for (auto& buffer : threadCommandBuffers)
+	{
+		if (!buffer->IsEmpty())
+		{
+			buffers.push_back(buffer.get());
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(foreignCommandBufferMutex);
+		for (auto& [thread, buffer] : foreignCommandBuffers)
+		{
+			if (!buffer->IsEmpty())
+			{
+				buffers.push_back(buffer.get());
+			}
+		}
+	}
+	if (buffers.empty())
+	{
+		return;
+	}
+
+	// Create entities first so every other command can be resolved to a real handle.
+	pendingCommands.clear();
+	uint32_t order = 0;
+	for (EntityCommandBuffer* buffer : buffers)
+	{
+		EcsVector<Entity>& created = createdEntities;
+		created.clear();
+		for (auto& command : buffer->GetCommands())
+		{
+			if (command.type == EntityCommandBuffer::CommandType::Create)
+			{
+				created.push_back(CreateEntity());
+			}
+		}
+		for (auto& command : buffer->GetCommands())
+		{
+			if (command.type == EntityCommandBuffer::CommandType::Create)
+			{
+				continue;
+			}
+			Entity entity = command.entity.IsProvisional() ? created[command.entity.GetId()] : command.entity;
+			pendingCommands.push_back({ entity, order++, &command });
+		}
+	}
+
+	std::sort(pendingCommands.begin(), pendingCommands.end(), [](const PendingCommand& a, const PendingCommand& b)
+	{
+		return a.entity.GetHandle() != b.entity.GetHandle() ? a.entity.GetHandle() < b.entity.GetHandle() : a.order < b.order;
+	});
+
+	const PendingCommand* begin = pendingCommands.data();
+	const PendingCommand* end = begin + pendingCommands.size();
+	while (begin != end)
+	{
+		const PendingCommand* groupEnd = begin;
+		while (groupEnd != end && groupEnd->entity == begin->entity)
+		{
+			++groupEnd;
+		}
+		ApplyCommands(begin->entity, begin, groupEnd);
+		begin = groupEnd;
+	}
+
+	for (EntityCommandBuffer* buffer : buffers)
+	{
+		buffer->Clear();
+	}
+}
+
+void ECSManager::DumpSchedule(std::ostream& out)
+{
+	if (!scheduler.IsBuilt())
+	{
+		scheduler.Build(systems);
+	}
+	scheduler.Dump(out);
+}
+
+std::vector<ComponentMemoryStats> ECSManager::GetComponentMemoryStats() const
+{
+	std::vector<ComponentMemoryStats> stats(ComponentRegistry::GetCount());
+	// Tags report their bit words as bytes; they take no pool allocations of their own.
+	for (ComponentTypeId type = 0; type < stats.size(); ++type)
+	{
+		stats[type].name = ComponentRegistry::GetInfo(type).name;
+		if (const SparseSetBase* pool = sparseSets[type].get())
+		{
+			stats[type].count = pool->Size();
+			stats[type].bytes = pool->GetReservedBytes();
+			stats[type].allocations = pool->GetAllocationCount();
+		}
+	}
+
+	for (const Archetype* archetype : archetypes)
+	{
+		const auto& components = archetype->GetComponents();
+		for (size_t column = 0; column < components.size(); ++column)
+		{
+			ComponentMemoryStats& entry = stats[archetype->GetTypes()[column]];
+			entry.count += archetype->GetEntityCount();
+			entry.bytes += archetype->GetChunkCount() * archetype->GetChunkCapacity() * components[column].size;
+			entry.chunkCheckouts += archetype->GetChunkCheckouts();
+		}
+		for (ComponentTypeId tag : archetype->GetTagTypes())
+		{
+			stats[tag].count += archetype->GetTagCount(tag);
+			stats[tag].bytes += archetype->GetTagBytes(tag);
+		}
+	}
+	return stats;
+}
+
+void ECSManager::DumpMemoryStats(std::ostream& out) const
+{
+	const ChunkPool::Stats& chunks = chunkPool.GetStats();
+	out << "Chunks: " << chunks.chunksInUse << " in use, " << chunks.chunksPooled << " pooled, "
+		<< chunks.systemAllocations << " system allocations, " << chunks.systemFrees << " system frees\n";
+	for (const ComponentMemoryStats& entry : GetComponentMemoryStats())
+	{
+		out << "  " << entry.name << ": " << entry.count << " live, " << entry.bytes << " bytes, "
+			<< entry.allocations << " allocations, " << entry.chunkCheckouts << " chunk checkouts\n";
+	}
+	// Shared by every world in the process.
+	const MemoryTagStats heap = MemoryTracker::GetStats(MemoryTag::ECS);
+	out << "ECS heap: " << heap.liveBytes << " live, " << heap.peakBytes << " peak, " << heap.allocations << " allocations\n";
+}
+
+const ECSManager::EntityRecord* ECSManager::FindRecord(Entity entity) const
+{
+	return IsAlive(entity) ? &entityRecords[entity.GetId()] : nullptr;
+}
+
+bool ECSManager::Matches(const EntityRecord& record, Entity entity, const Signature& required) const
+{
+	// Anything the archetype lacks has to be a tag bit or found in a sparse-set pool.
+	Signature missing = required & ~record.archetype->GetSignature();
+	for (ComponentTypeId type = 0; missing.any(); ++type)
+	{
+		if (missing.test(type))
+		{
+			bool found = ComponentRegistry::GetInfo(type).tag
+				? record.archetype->HasTag(type, record.chunk, record.row)
+				: sparseSets[type] && sparseSets[type]->Contains(entity);
+			if (!found)
+			{
+				return false;
+			}
+			missing.reset(type);
+		}
+	}
+	return true;
+}
+
+void ECSManager::MarkDirty(Entity::IdType index)
+{
+	EntityRecord& record = entityRecords[index];
+	if (!membershipStale && !matchingSystems.empty() && !record.dirty)
+	{
+		record.dirty = true;
+		dirtyEntities.push_back(index);
+	}
+}
+
+Archetype* ECSManager::GetOrCreateArchetype(const Signature& signature)
+{
+	auto& slot = archetypeIndex[signature];
+	if (!slot)
+	{
+		slot = std::make_unique<Archetype>(signature, chunkPool);
+		archetypes.push_back(slot.get());
+		std::lock_guard<std::mutex> lock(queryMutex);
+		for (auto& [required, cache] : queries)
+		{
+			if ((signature & required) == required)
+			{
+				cache->archetypes.push_back(slot.get());
+			}
+		}
+	}
+	return slot.get();
+}
+
+QueryCache& ECSManager::GetQueryCache(const Signature& required)
+{
+	// Systems running in parallel may resolve views at the same time.
+	std::lock_guard<std::mutex> lock(queryMutex);
+	auto& cache = queries[required];
+	if (!cache)
+	{
+		cache = std::make_unique<QueryCache>();
+		cache->required = required;
+		for (Archetype* archetype : archetypes)
+		{
+			if ((archetype->GetSignature() & required) == required)
+			{
+				cache->archetypes.push_back(archetype);
+			}
+		}
+	}
+	return *cache;
+}
+
+Archetype* ECSManager::GetArchetypeWith(Archetype* source, ComponentTypeId type)
+{
+	if (Archetype* cached = source->GetAddEdge(type))
+	{
+		return cached;
 	}
-}
\ No newline at end of file
+	Archetype* target = GetOrCreateArchetype(Signature(source->GetSignature()).set(type));
+	source->SetAddEdge(type, target);
+	target->SetRemoveEdge(type, source);
+	return target;
+}
+
+Archetype* ECSManager::GetArchetypeWithout(Archetype* source, ComponentTypeId type)
+{
+	if (Archetype* cached = source->GetRemoveEdge(type))
+	{
+		return cached;
+	}
+	Archetype* target = GetOrCreateArchetype(Signature(source->GetSignature()).reset(type));
+	source->SetRemoveEdge(type, target);
+	target->SetAddEdge(type, source);
+	return target;
+}
+
+void ECSManager::MoveEntity(Entity entity, Archetype* target)
+{
+	EntityRecord& record = entityRecords[entity.GetId()];
+	Archetype* source = record.archetype;
+	auto [chunk, row] = target->AllocateRow(entity, GetChangeVersion());
+
+	// Carry over shared columns, drop the rest; columns new to target stay uninitialised.
+	const auto& components = source->GetComponents();
+	const auto& types = source->GetTypes();
+	for (size_t column = 0; column < components.size(); ++column)
+	{
+		void* src = source->GetComponent(record.chunk, record.row, column);
+		int targetColumn = target->FindColumn(types[column]);
+		if (targetColumn >= 0)
+		{
+			components[column].moveConstruct(target->GetComponent(chunk, row, targetColumn), src);
+		}
+		components[column].destroy(src);
+	}
+	for (ComponentTypeId tag : source->GetTagTypes())
+	{
+		if (source->HasTag(tag, record.chunk, record.row))
+		{
+			target->SetTag(tag, chunk, row, true);
+		}
+	}
+
+	RemoveRow(source, record.chunk, record.row);
+	record.archetype = target;
+	record.chunk = chunk;
+	record.row = row;
+	MarkDirty(entity.GetId());
+}
+
+void ECSManager::ApplyCommands(Entity entity, const PendingCommand* begin, const PendingCommand* end)
+{
+	using CommandType = EntityCommandBuffer::CommandType;
+	if (!IsAlive(entity))
+	{
+		return;
+	}
+
+	// Fold the entity's commands into one target signature plus the last value added per
+	// archetype component. Tags and sparse-set components never move the entity, so they
+	// are applied in order. Payloads left unconsumed are destroyed when the buffer clears.
+	const Signature original = entityRecords[entity.GetId()].archetype->GetSignature();
+	Signature target = original;
+	std::array<EntityCommandBuffer::Command*, MaxComponentTypes> values = {};
+	for (const PendingCommand* pending = begin; pending != end; ++pending)
+	{
+		EntityCommandBuffer::Command& command = *pending->command;
+		if (command.type == CommandType::Destroy)
+		{
+			DestroyEntity(entity);
+			return;
+		}
+
+		const ComponentInfo& info = ComponentRegistry::GetInfo(command.component);
+		if (info.tag)
+		{
+			// Tag bits move with the entity if it changes archetype below.
+			const EntityRecord& record = entityRecords[entity.GetId()];
+			record.archetype->SetTag(command.component, record.chunk, record.row, command.type == CommandType::AddComponent);
+			MarkDirty(entity.GetId());
+			if (command.payload)
+			{
+				info.destroy(command.payload);
+				command.payload = nullptr;
+			}
+			continue;
+		}
+		if (info.createSparseSet)
+		{
+			auto& pool = sparseSets[command.component];
+			if (command.type == CommandType::AddComponent)
+			{
+				if (!pool)
+				{
+					pool.reset(info.createSparseSet());
+				}
+				pool->EmplaceMoved(entity, command.payload);
+				MarkDirty(entity.GetId());
+				info.destroy(command.payload);
+				command.payload = nullptr;
+			}
+			else if (pool)
+			{
+				pool->Remove(entity);
+				MarkDirty(entity.GetId());
+			}
+			continue;
+		}
+
+		if (command.type == CommandType::AddComponent)
+		{
+			target.set(command.component);
+			values[command.component] = &command;
+		}
+		else
+		{
+			target.reset(command.component);
+			values[command.component] = nullptr;
+		}
+	}
+
+	if (target != original)
+	{
+		MoveEntity(entity, GetOrCreateArchetype(target));
+	}
+
+	const EntityRecord& record = entityRecords[entity.GetId()];
+	for (ComponentTypeId type = 0; type < MaxComponentTypes; ++type)
+	{
+		EntityCommandBuffer::Command* command = values[type];
+		if (!command)
+		{
+			continue;
+		}
+		const ComponentInfo& info = ComponentRegistry::GetInfo(type);
+		const int column = record.archetype->FindColumn(type);
+		void* destination = record.archetype->GetComponent(record.chunk, record.row, column);
+		if (original.test(type))
+		{
+			info.destroy(destination);
+		}
+		info.moveConstruct(destination, command->payload);
+		record.archetype->MarkChanged(record.archetype->GetChunk(record.chunk), column, GetChangeVersion());
+		info.destroy(command->payload);
+		command->payload = nullptr;
+	}
+}
+
+void ECSManager::ResizeCommandBuffers(size_t threadCount)
+{
+	PlaybackCommandBuffers();
+	threadCommandBuffers.resize(threadCount);
+	for (auto& buffer : threadCommandBuffers)
+	{
+		if (!buffer)
+		{
+			buffer = std::make_unique<EntityCommandBuffer>();
+		}
+	}
+}
+
+void ECSManager::RemoveRow(Archetype* archetype, uint32_t chunk, uint32_t row)
+{
+	archetype->RemoveRow(chunk, row, GetChangeVersion());
+
+	// The archetype's last entity was swapped into the hole; point its record at it.
+	if (chunk < archetype->GetChunkCount() && row < archetype->GetChunk(chunk).count)
+	{
+		Entity moved = archetype->GetEntities(archetype->GetChunk(chunk))[row];
+		entityRecords[moved.GetId()].chunk = chunk;
+		entityRecords[moved.GetId()].row = row;
+	}
+}
@@ -0,0 +1,62 @@
+#include "../include/EntityCommandBuffer.h"
+#include <algorithm>
+
+EntityCommandBuffer::~EntityCommandBuffer()
+{
+	Clear();
+}
+
+Entity EntityCommandBuffer::CreateEntity()
+{
+	Entity entity(createdCount++, Entity::ProvisionalGeneration);
+	commands.push_back({ CommandType::Create, 0, entity, nullptr });
+	return entity;
+}
+
+void EntityCommandBuffer::DestroyEntity(Entity entity)
+{
+	commands.push_back({ CommandType::Destroy, 0, entity, nullptr });
+}
+
+void EntityCommandBuffer::Clear()
+{
+	// Playback nulls out the payloads it moves from.
+	for (auto& command : commands)
+	{
+		if (command.payload)
+		{
+			ComponentRegistry::GetInfo(command.component).destroy(command.payload);
+		}
+	}
+	commands.clear();
+	currentBlock = 0;
+	blockOffset = 0;
+	createdCount = 0;
+}
+
+void* EntityCommandBuffer::AllocatePayload(size_t size, size_t alignment)
+{
+	// Blocks never move once allocated, so payloads with self-referencing members
+	// stay valid until playback.
+	for (;;)
+	{
+		if (currentBlock < blocks.size())
+		{
+			Block& block = blocks[currentBlock];
+			uintptr_t base = reinterpret_cast<uintptr_t>(block.data.data());
+			size_t offset = ((base + blockOffset + alignment - 1) & ~(alignment - 1)) - base;
+			if (offset + size <= block.data.size())
+			{
+				blockOffset = offset + size;
+				return block.data.data() + offset;
+			}
+			++currentBlock;
+			blockOffset = 0;
+			continue;
+		}
+
+		Block block;
+		block.data.resize(std::max(BlockSize, size + alignment));
+		blocks.push_back(std::move(block));
+	}
+}
@@ -0,0 +1,27 @@
+#include "../include/Prefab.h"
+
+Prefab::~Prefab()
+{
+	for (const Value& value : values)
+	{
+		const ComponentInfo& info = ComponentRegistry::GetInfo(value.type);
+		info.destroy(value.data);
+		MemoryTracker::Free(value.data, info.size, info.alignment, MemoryTag::ECS);
+	}
+}
+
+void* Prefab::Find(ComponentTypeId type) const
+{
+	if (!signature.test(type))
+	{
+		return nullptr;
+	}
+	for (const Value& value : values)
+	{
+		if (value.type == type)
+		{
+			return value.data;
+		}
+	}
+	return nullptr;
+}
@@ -0,0 +1,448 @@
+#include "../include/RollbackBuffer.h"
+#include "../include/ECSManager.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <unordered_set>
+
+namespace
+{
+	// Equal bytes shorter than this stay inside a literal rather than ending it.
+	constexpr size_t MinRun = 8;
+
+	size_t SkipEqual(const std::byte* data, const std::byte* base, size_t i, size_t size)
+	{
+		for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+		{
+			uint64_t a;
+			uint64_t b;
+			std::memcpy(&a, data + i, sizeof(a));
+			std::memcpy(&b, base + i, sizeof(b));
+			if (a != b)
+			{
+				break;
+			}
+		}
+		while (i < size && data[i] == base[i])
+		{
+			++i;
+		}
+		return i;
+	}
+
+	void WriteVarint(EcsVector<std::byte>& out, size_t value)
+	{
+		while (value >= 0x80)
+		{
+			out.push_back(static_cast<std::byte>(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back(static_cast<std::byte>(value));
+	}
+
+	size_t ReadVarint(const std::byte*& in)
+	{
+		size_t value = 0;
+		for (int shift = 0;; shift += 7)
+		{
+			const uint8_t byte = static_cast<uint8_t>(*in++);
+			value |= size_t(byte & 0x7f) << shift;
+			if (byte < 0x80)
+			{
+				return value;
+			}
+		}
+	}
+
+	// Delta of data against base as (equal byte count, literal count, literal XOR bytes)
+	// runs. Trailing equal bytes are omitted, so identical inputs encode to nothing.
+	void EncodeXor(const std::byte* data, const std::byte* base, size_t size, EcsVector<std::byte>& out)
+	{
+		out.clear();
+		size_t i = 0;
+		while (i < size)
+		{
+			const size_t start = i;
+			i = SkipEqual(data, base, i, size);
+			if (i == size)
+			{
+				break;
+			}
+			const size_t literal = i;
+			while (i < size)
+			{
+				if (data[i] != base[i])
+				{
+					++i;
+					continue;
+				}
+				const size_t run = SkipEqual(data, base, i, size);
+				if (run - i >= MinRun || run == size)
+				{
+					break;
+				}
+				i = run;
+			}
+			WriteVarint(out, literal - start);
+			WriteVarint(out, i - literal);
+			for (size_t k = literal; k < i; ++k)
+			{
+				out.push_back(data[k] ^ base[k]);
+			}
+		}
+	}
+}
+
+RollbackBuffer::RollbackBuffer(size_t capacity)
+	: frames(std::max<size_t>(capacity, 1))
+{
+}
+
+RollbackBuffer::Frame* RollbackBuffer::Find(uint64_t tick)
+{
+	return const_cast<Frame*>(static_cast<const RollbackBuffer*>(this)->Find(tick));
+}
+
+const RollbackBuffer::Frame* RollbackBuffer::Find(uint64_t tick) const
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (At(i).tick == tick)
+		{
+			return &At(i);
+		}
+	}
+	return nullptr;
+}
+
+RollbackBuffer::Block RollbackBuffer::Encode(const void* data, size_t size, const Block* previous)
+{
+	const std::byte* bytes = static_cast<const std::byte*>(data);
+	if (previous && previous->base && previous->base->size() == size)
+	{
+		EncodeXor(bytes, previous->base->data(), size, delta);
+		if (delta.empty())
+		{
+			return { previous->base, nullptr };
+		}
+		if (delta.size() <= size / 4)
+		{
+			return { previous->base, std::allocate_shared<const Bytes>(TrackedAllocator<Bytes, MemoryTag::ECS>(), delta) };
+		}
+	}
+	return { std::allocate_shared<const Bytes>(TrackedAllocator<Bytes, MemoryTag::ECS>(), bytes, bytes + size), nullptr };
+}
+
+void RollbackBuffer::Decode(const Block& block, void* out)
+{
+	if (!block.base || block.base->empty())
+	{
+		return;
+	}
+	std::byte* bytes = static_cast<std::byte*>(out);
+	std::memcpy(bytes, block.base->data(), block.base->size());
+	if (!block.delta)
+	{
+		return;
+	}
+	const std::byte* in = block.delta->data();
+	const std::byte* end = in + block.delta->size();
+	size_t position = 0;
+	while (in < end)
+	{
+		position += ReadVarint(in);
+		const size_t literal = ReadVarint(in);
+		for (size_t k = 0; k < literal; ++k)
+		{
+			bytes[position + k] ^= in[k];
+		}
+		in += literal;
+		position += literal;
+	}
+}
+
+void RollbackBuffer::Release(Frame& frame)
+{
+	// Drops the blocks but keeps vector capacity for the next frame built in this slot.
+	frame.generations = {};
+	frame.freeIndices = {};
+	for (ArchetypeState& state : frame.archetypes)
+	{
+		state.counts.clear();
+		state.chunks.clear();
+		state.tags.clear();
+	}
+	frame.sparse.clear();
+}
+
+bool RollbackBuffer::Save(ECSManager& world, uint64_t tick)
+{
+	for (const Archetype* archetype : world.archetypes)
+	{
+		for (const ComponentInfo& info : archetype->GetComponents())
+		{
+			if (archetype->GetEntityCount() > 0 && !info.trivial)
+			{
+				std::cerr << "Rollback cannot save " << info.name << ": not trivially copyable" << std::endl;
+				return false;
+			}
+		}
+	}
+	for (ComponentTypeId type = 0; type < MaxComponentTypes; ++type)
+	{
+		if (world.sparseSets[type] && world.sparseSets[type]->Size() > 0 && !ComponentRegistry::GetInfo(type).trivial)
+		{
+			std::cerr << "Rollback cannot save " << ComponentRegistry::GetInfo(type).name << ": not trivially copyable" << std::endl;
+			return false;
+		}
+	}
+
+	// Writes after this point are stamped later than version.
+	const uint32_t version = world.changeVersion.fetch_add(1, std::memory_order_relaxed);
+	const Frame* previous = hasLast ? Find(lastTick) : nullptr;
+	Frame& frame = pending;
+	frame.tick = tick;
+
+	frame.archetypes.resize(world.archetypes.size());
+	for (size_t a = 0; a < world.archetypes.size(); ++a)
+	{
+		const Archetype& archetype = *world.archetypes[a];
+		ArchetypeState& state = frame.archetypes[a];
+		const ArchetypeState* before = previous && a < previous->archetypes.size() ? &previous->archetypes[a] : nullptr;
+		const size_t chunkCount = archetype.GetChunkCount();
+		const size_t columns = archetype.GetComponents().size();
+		state.counts.resize(chunkCount);
+		state.chunks.resize(chunkCount);
+		for (size_t c = 0; c < chunkCount; ++c)
+		{
+			const Archetype::Chunk& chunk = archetype.GetChunk(c);
+			state.counts[c] = chunk.count;
+			const Block* old = before && c < before->chunks.size() ? &before->chunks[c] : nullptr;
+
+			// Untouched since the last save or restore: share that frame's block.
+			const uint32_t* versions = archetype.GetVersions(chunk);
+			if (old && before->counts[c] == chunk.count && columns > 0
+				&& std::all_of(versions, versions + columns, [&](uint32_t v) { return v <= lastVersion; }))
+			{
+				state.chunks[c] = *old;
+				continue;
+			}
+			state.chunks[c] = Encode(chunk.data, ChunkPool::ChunkSize, old);
+		}
+
+		state.tags.clear();
+		for (ComponentTypeId tag : archetype.GetTagTypes())
+		{
+			if (chunkCount == 0)
+			{
+				continue;
+			}
+			const Block* old = nullptr;
+			for (size_t t = 0; before && t < before->tags.size() && !old; ++t)
+			{
+				old = before->tags[t].first == tag ? &before->tags[t].second : nullptr;
+			}
+			state.tags.emplace_back(tag, Encode(archetype.GetTagBits(tag, 0), chunkCount * archetype.GetTagWords() * sizeof(uint64_t), old));
+		}
+	}
+
+	words.resize(world.entityRecords.size());
+	for (size_t index = 0; index < words.size(); ++index)
+	{
+		words[index] = world.entityRecords[index].generation;
+	}
+	frame.generations = Encode(words.data(), words.size() * sizeof(uint32_t), previous ? &previous->generations : nullptr);
+	frame.freeIndices = Encode(world.freeIndices.data(), world.freeIndices.size() * sizeof(Entity::IdType), previous ? &previous->freeIndices : nullptr);
+
+	frame.sparse.clear();
+	for (ComponentTypeId type = 0; type < MaxComponentTypes; ++type)
+	{
+		const SparseSetBase* pool = world.sparseSets[type].get();
+		if (!pool || pool->Size() == 0)
+		{
+			continue;
+		}
+		const SparseState* old = nullptr;
+		for (size_t s = 0; previous && s < previous->sparse.size() && !old; ++s)
+		{
+			old = previous->sparse[s].type == type ? &previous->sparse[s] : nullptr;
+		}
+		SparseState state;
+		state.type = type;
+		state.entities = Encode(pool->GetEntityData(), pool->Size() * sizeof(Entity), old ? &old->entities : nullptr);
+		state.components = Encode(pool->GetComponentData(), pool->Size() * ComponentRegistry::GetInfo(type).size, old ? &old->components : nullptr);
+		frame.sparse.push_back(std::move(state));
+	}
+
+	// Re-simulated ticks replace the ones stored after them.
+	while (count > 0 && At(count - 1).tick >= tick)
+	{
+		Release(At(--count));
+	}
+	if (count == frames.size())
+	{
+		Release(At(0));
+		first = (first + 1) % frames.size();
+		--count;
+	}
+	std::swap(At(count), pending);
+	++count;
+	Release(pending);
+
+	hasLast = true;
+	lastTick = tick;
+	lastVersion = version;
+	return true;
+}
+
+bool RollbackBuffer::Restore(ECSManager& world, uint64_t tick)
+{
+	const Frame* frame = Find(tick);
+	if (!frame)
+	{
+		return false;
+	}
+	const uint32_t version = world.changeVersion.fetch_add(1, std::memory_order_relaxed);
+
+	for (size_t a = 0; a < world.archetypes.size(); ++a)
+	{
+		Archetype& archetype = *world.archetypes[a];
+		// Saves refuse such components, so they can only be in rows added since; destroy
+		// them properly before the archetype is overwritten.
+		const auto& components = archetype.GetComponents();
+		for (size_t column = 0; column < components.size(); ++column)
+		{
+			for (size_t c = 0; !components[column].trivial && c < archetype.GetChunkCount(); ++c)
+			{
+				for (uint32_t row = 0; row < archetype.GetChunk(c).count; ++row)
+				{
+					components[column].destroy(archetype.GetComponent(static_cast<uint32_t>(c), row, column));
+				}
+			}
+		}
+
+		if (a >= frame->archetypes.size())
+		{
+			archetype.SetChunkCounts(nullptr, 0);
+			continue;
+		}
+		const ArchetypeState& state = frame->archetypes[a];
+		archetype.SetChunkCounts(state.counts.data(), state.counts.size());
+		for (size_t c = 0; c < state.chunks.size(); ++c)
+		{
+			const Archetype::Chunk& chunk = archetype.GetChunk(c);
+			Decode(state.chunks[c], chunk.data);
+			// Restored data counts as changed, so systems rebuild anything derived from it.
+			for (size_t column = 0; column < components.size(); ++column)
+			{
+				archetype.MarkChanged(chunk, column, version);
+			}
+		}
+		for (const auto& [tag, block] : state.tags)
+		{
+			Decode(block, archetype.GetTagStorage(tag).data());
+		}
+	}
+
+	words.resize(GetSize(frame->generations) / sizeof(uint32_t));
+	Decode(frame->generations, words.data());
+	world.entityRecords.assign(words.size(), ECSManager::EntityRecord());
+	for (size_t index = 0; index < words.size(); ++index)
+	{
+		world.entityRecords[index].generation = words[index];
+	}
+	for (Archetype* archetype : world.archetypes)
+	{
+		for (uint32_t c = 0; c < archetype->GetChunkCount(); ++c)
+		{
+			const Archetype::Chunk& chunk = archetype->GetChunk(c);
+			const Entity* entities = archetype->GetEntities(chunk);
+			for (uint32_t row = 0; row < chunk.count; ++row)
+			{
+				ECSManager::EntityRecord& record = world.entityRecords[entities[row].GetId()];
+				record.archetype = archetype;
+				record.chunk = c;
+				record.row = row;
+			}
+		}
+	}
+	world.freeIndices.resize(GetSize(frame->freeIndices) / sizeof(Entity::IdType));
+	Decode(frame->freeIndices, world.freeIndices.data());
+
+	for (auto& pool : world.sparseSets)
+	{
+		if (pool)
+		{
+			pool->Clear();
+		}
+	}
+	for (const SparseState& state : frame->sparse)
+	{
+		const ComponentInfo& info = ComponentRegistry::GetInfo(state.type);
+		auto& pool = world.sparseSets[state.type];
+		if (!pool)
+		{
+			pool.reset(info.createSparseSet());
+		}
+		const size_t size = GetSize(state.entities) / sizeof(Entity);
+		entityScratch.resize(GetSize(state.entities));
+		componentScratch.resize(GetSize(state.components));
+		Decode(state.entities, entityScratch.data());
+		Decode(state.components, componentScratch.data());
+		pool->Reserve(size);
+		for (size_t i = 0; i < size; ++i)
+		{
+			Entity entity(0);
+			std::memcpy(&entity, entityScratch.data() + i * sizeof(Entity), sizeof(Entity));
+			pool->EmplaceCopied(entity, componentScratch.data() + i * info.size);
+		}
+	}
+
+	world.dirtyEntities.clear();
+	world.membershipStale = true;
+	hasLast = true;
+	lastTick = tick;
+	lastVersion = version;
+	return true;
+}
+
+RollbackBuffer::Stats RollbackBuffer::GetStats() const
+{
+	Stats stats;
+	stats.frames = count;
+	std::unordered_set<const Bytes*> seen;
+	auto add = [&](const Block& block)
+	{
+		for (const Bytes* bytes : { block.base.get(), block.delta.get() })
+		{
+			if (bytes && seen.insert(bytes).second)
+			{
+				++stats.blocks;
+				stats.bytes += bytes->size();
+			}
+		}
+	};
+	for (size_t i = 0; i < count; ++i)
+	{
+		const Frame& frame = At(i);
+		add(frame.generations);
+		add(frame.freeIndices);
+		for (const ArchetypeState& state : frame.archetypes)
+		{
+			for (const Block& block : state.chunks)
+			{
+				add(block);
+			}
+			for (const auto& [tag, block] : state.tags)
+			{
+				add(block);
+			}
+		}
+		for (const SparseState& state : frame.sparse)
+		{
+			add(state.entities);
+			add(state.components);
+		}
+	}
+	return stats;
+}
@@ -0,0 +1,92 @@
+#include "../include/SystemGroup.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+SystemGroups::SystemGroups()
+{
+	Add("Default", SystemGroupSettings());
+}
+
+SystemGroupId SystemGroups::Add(std::string name, const SystemGroupSettings& settings)
+{
+	Group group;
+	group.name = std::move(name);
+	group.settings = settings;
+	group.settings.slices = std::clamp(settings.slices, 1u, MaxSlices);
+	SetSliceCount(group, group.settings.slices);
+	budgeted = budgeted || settings.budgetMilliseconds > 0.0f;
+	// Golden ratio phases keep groups with equal rates apart however many are added.
+	double phase = std::fmod(static_cast<double>(groups.size()) * 0.6180339887, 1.0);
+	group.next = time + GetInterval(group) * phase;
+	groups.push_back(std::move(group));
+	deltas.push_back(NotDue);
+	return static_cast<SystemGroupId>(groups.size() - 1);
+}
+
+double SystemGroups::GetInterval(const Group& group) const
+{
+	return group.settings.tickRate > 0.0f ? 1.0 / (group.settings.tickRate * group.sliceLastRun.size()) : 0.0;
+}
+
+void SystemGroups::SetSliceCount(Group& group, uint32_t count)
+{
+	// Slices start over at 0; each is treated as last run a step ago.
+	group.slice = count - 1;
+	group.sliceLastRun.assign(count, time - group.lastDelta);
+	group.stats.slices = count;
+}
+
+const std::vector<float>& SystemGroups::BeginTick(float deltaTime)
+{
+	time += deltaTime;
+	for (size_t id = 0; id < groups.size(); ++id)
+	{
+		Group& group = groups[id];
+		if (time < group.next)
+		{
+			deltas[id] = NotDue;
+			continue;
+		}
+		const double interval = GetInterval(group);
+		group.next += interval;
+		if (group.next <= time)
+		{
+			group.next = time + interval;
+		}
+
+		group.slice = (group.slice + 1) % group.sliceLastRun.size();
+		double& lastRun = group.sliceLastRun[group.slice];
+		group.lastDelta = static_cast<float>(time - lastRun);
+		lastRun = time;
+		deltas[id] = group.lastDelta;
+	}
+	return deltas;
+}
+
+void SystemGroups::EndTick(SystemGroupId id, float milliseconds)
+{
+	Group& group = groups[id];
+	assert(deltas[id] != NotDue && "EndTick for a group that did not run");
+	group.stats.runs++;
+	group.stats.lastMilliseconds = milliseconds;
+
+	const float budget = group.settings.budgetMilliseconds;
+	if (budget <= 0.0f)
+	{
+		return;
+	}
+	const uint32_t slices = GetSliceCount(id);
+	if (milliseconds > budget)
+	{
+		group.stats.overBudgetRuns++;
+		if (slices < MaxSlices)
+		{
+			SetSliceCount(group, std::min(slices * 2, MaxSlices));
+		}
+	}
+	else if (milliseconds < budget / 4 && slices / 2 >= group.settings.slices)
+	{
+		SetSliceCount(group, slices / 2);
+	}
+}
@@ -0,0 +1,197 @@
+#include "../include/SystemScheduler.h"
+#include "../../core/include/JobSystem.h"
+#include "../../core/include/Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+void SystemScheduler::Build(const std::vector<std::shared_ptr<System>>& systems)
+{
+	nodes.assign(systems.size(), Node{});
+	for (size_t i = 0; i < systems.size(); ++i)
+	{
+		nodes[i].system = systems[i].get();
+		nodes[i].group = systems[i]->GetGroup();
+		for (size_t j = 0; j < i; ++j)
+		{
+			if (Conflicts(*systems[j], *systems[i]))
+			{
+				nodes[j].dependents.push_back(i);
+				++nodes[i].dependencyCount;
+				nodes[i].stage = std::max(nodes[i].stage, nodes[j].stage + 1);
+			}
+		}
+	}
+	remaining.reset(new std::atomic<size_t>[nodes.size()]);
+	built = true;
+}
+
+bool SystemScheduler::Conflicts(const System& a, const System& b)
+{
+	if (!a.DeclaresAccess() || !b.DeclaresAccess())
+	{
+		return true;
+	}
+	return (a.GetWrites() & (b.GetReads() | b.GetWrites())).any() || (b.GetWrites() & a.GetReads()).any();
+}
+
+void SystemScheduler::Run(const std::vector<float>& groupDeltas, JobSystem* jobs, std::atomic<uint32_t>& changeVersion, bool timed)
+{
+	if (nodes.empty())
+	{
+		return;
+	}
+
+	versions = &changeVersion;
+	deltas = &groupDeltas;
+	this->timed = timed;
+	allocationCounter = timed ? SystemTimings::GetAllocationCounter() : nullptr;
+	pending.store(nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i)
+	{
+		remaining[i].store(nodes[i].dependencyCount, std::memory_order_relaxed);
+	}
+	for (size_t i = 0; i < nodes.size(); ++i)
+	{
+		if (nodes[i].dependencyCount == 0)
+		{
+			Dispatch(i, jobs);
+		}
+	}
+
+	while (pending.load(std::memory_order_acquire) > 0)
+	{
+		size_t node = nodes.size();
+		{
+			std::lock_guard<std::mutex> lock(mainThreadMutex);
+			if (!mainThreadQueue.empty())
+			{
+				node = mainThreadQueue.front();
+				mainThreadQueue.pop_front();
+			}
+		}
+
+		if (node < nodes.size())
+		{
+			Execute(node, jobs);
+		}
+		else if (!jobs || !jobs->RunPendingJob())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void SystemScheduler::Dispatch(size_t node, JobSystem* jobs)
+{
+	if ((*deltas)[nodes[node].group] == SystemGroups::NotDue)
+	{
+		nodes[node].nanoseconds = 0;
+		nodes[node].allocations = 0;
+		Complete(node, jobs);
+		return;
+	}
+
+	if (!jobs || nodes[node].system->RunsOnMainThread())
+	{
+		std::lock_guard<std::mutex> lock(mainThreadMutex);
+		mainThreadQueue.push_back(node);
+		return;
+	}
+
+	jobs->Run([this, node, jobs] { Execute(node, jobs); });
+}
+
+void SystemScheduler::Execute(size_t node, JobSystem* jobs)
+{
+	Node& entry = nodes[node];
+	PROFILE_ZONE(entry.system->GetName());
+	if (!timed)
+	{
+		entry.system->Run((*deltas)[entry.group], versions->fetch_add(1) + 1);
+		entry.nanoseconds = 0;
+		entry.allocations = 0;
+		Complete(node, jobs);
+		return;
+	}
+
+	const uint64_t allocationsBefore = allocationCounter ? allocationCounter() : 0;
+	auto start = std::chrono::steady_clock::now();
+	entry.system->Run((*deltas)[entry.group], versions->fetch_add(1) + 1);
+	entry.nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	entry.allocations = allocationCounter ? static_cast<uint32_t>(allocationCounter() - allocationsBefore) : 0;
+	Complete(node, jobs);
+}
+
+void SystemScheduler::Complete(size_t node, JobSystem* jobs)
+{
+	for (size_t dependent : nodes[node].dependents)
+	{
+		if (remaining[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			Dispatch(dependent, jobs);
+		}
+	}
+	pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void SystemScheduler::Dump(std::ostream& out) const
+{
+	auto describe = [](const Signature& signature)
+	{
+		std::string names;
+		for (ComponentTypeId type = 0; type < ComponentRegistry::GetCount(); ++type)
+		{
+			if (signature.test(type))
+			{
+				names += names.empty() ? "" : ", ";
+				names += ComponentRegistry::GetInfo(type).name;
+			}
+		}
+		return names.empty() ? std::string("-") : names;
+	};
+
+	size_t stageCount = 0;
+	for (const Node& node : nodes)
+	{
+		stageCount = std::max(stageCount, node.stage + 1);
+	}
+
+	out << "System schedule: " << nodes.size() << " systems in " << stageCount << " stages\n";
+	for (size_t stage = 0; stage < stageCount; ++stage)
+	{
+		out << "Stage " << stage << ":\n";
+		for (size_t i = 0; i < nodes.size(); ++i)
+		{
+			const Node& node = nodes[i];
+			if (node.stage != stage)
+			{
+				continue;
+			}
+			const System& system = *node.system;
+			out << "  [" << i << "] " << system.GetName();
+			if (node.group != DefaultSystemGroup)
+			{
+				out << " (group " << node.group << ")";
+			}
+			if (system.RunsOnMainThread())
+			{
+				out << " (main thread)";
+			}
+			if (system.DeclaresAccess())
+			{
+				out << " reads {" << describe(system.GetReads()) << "} writes {" << describe(system.GetWrites()) << "}";
+			}
+			else
+			{
+				out << " (undeclared access, runs exclusively)";
+			}
+			out << "\n";
+			for (size_t dependent : node.dependents)
+			{
+				out << "      -> [" << dependent << "] " << nodes[dependent].system->GetName() << "\n";
+			}
+		}
+	}
+}
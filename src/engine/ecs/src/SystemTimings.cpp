@@ -0,0 +1,126 @@
+#include "../include/SystemTimings.h"
+#include "../include/System.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+void SystemTimings::Bind(const std::vector<std::shared_ptr<System>>& systems)
+{
+	bound.clear();
+	for (const auto& system : systems)
+	{
+		auto found = std::find_if(tracks.begin(), tracks.end(), [&](const auto& track) { return track->system == system.get(); });
+		if (found == tracks.end())
+		{
+			tracks.push_back(std::make_unique<Track>());
+			tracks.back()->system = system.get();
+			found = tracks.end() - 1;
+		}
+		(*found)->name = system->GetName();
+		(*found)->group = system->GetGroup();
+		bound.push_back(found->get());
+	}
+}
+
+void SystemTimings::Record(size_t system, uint64_t frame, int64_t nanoseconds, uint32_t entities, uint32_t allocations)
+{
+	Track& track = *bound[system];
+	const uint64_t index = track.written.load(std::memory_order_relaxed);
+	Slot& slot = track.slots[index % Capacity];
+	slot.frame.store(frame, std::memory_order_relaxed);
+	slot.nanoseconds.store(nanoseconds, std::memory_order_relaxed);
+	slot.entities.store(entities, std::memory_order_relaxed);
+	slot.allocations.store(allocations, std::memory_order_relaxed);
+	track.written.store(index + 1, std::memory_order_release);
+}
+
+std::vector<SystemTimingSummary> SystemTimings::Summarize() const
+{
+	std::vector<SystemTimingSummary> summaries;
+	std::vector<int64_t> times;
+	for (const auto& track : tracks)
+	{
+		SystemTimingSummary summary;
+		summary.name = track->name;
+		summary.group = track->group;
+		const uint64_t written = track->written.load(std::memory_order_acquire);
+		summary.samples = static_cast<size_t>(std::min<uint64_t>(written, Capacity));
+
+		times.clear();
+		double entities = 0.0;
+		double allocations = 0.0;
+		for (uint64_t i = written - summary.samples; i < written; ++i)
+		{
+			const Slot& slot = track->slots[i % Capacity];
+			times.push_back(slot.nanoseconds.load(std::memory_order_relaxed));
+			entities += slot.entities.load(std::memory_order_relaxed);
+			allocations += slot.allocations.load(std::memory_order_relaxed);
+		}
+		if (!times.empty())
+		{
+			const double count = static_cast<double>(times.size());
+			auto [min, max] = std::minmax_element(times.begin(), times.end());
+			summary.minMilliseconds = *min * 1e-6;
+			summary.maxMilliseconds = *max * 1e-6;
+			double total = 0.0;
+			for (int64_t time : times)
+			{
+				total += static_cast<double>(time);
+			}
+			summary.averageMilliseconds = total / count * 1e-6;
+			auto p99 = times.begin() + (times.size() * 99) / 100;
+			std::nth_element(times.begin(), p99, times.end());
+			summary.p99Milliseconds = *p99 * 1e-6;
+			summary.averageEntities = entities / count;
+			summary.averageAllocations = allocations / count;
+		}
+		summaries.push_back(std::move(summary));
+	}
+	return summaries;
+}
+
+void SystemTimings::WriteCsv(std::ostream& out) const
+{
+	out << "system,group,samples,min_ms,avg_ms,p99_ms,max_ms,avg_entities,avg_allocations\n";
+	for (const SystemTimingSummary& summary : Summarize())
+	{
+		out << summary.name << ',' << summary.group << ',' << summary.samples << ',' << summary.minMilliseconds << ','
+			<< summary.averageMilliseconds << ',' << summary.p99Milliseconds << ',' << summary.maxMilliseconds << ','
+			<< summary.averageEntities << ',' << summary.averageAllocations << '\n';
+	}
+}
+
+void SystemTimings::WriteJson(std::ostream& out) const
+{
+	const std::vector<SystemTimingSummary> summaries = Summarize();
+	out << "{\n  \"systems\": [\n";
+	for (size_t i = 0; i < summaries.size(); ++i)
+	{
+		const SystemTimingSummary& summary = summaries[i];
+		out << "    { \"name\": \"" << summary.name << "\", \"group\": " << summary.group << ", \"samples\": " << summary.samples
+			<< ", \"minMs\": " << summary.minMilliseconds << ", \"avgMs\": " << summary.averageMilliseconds
+			<< ", \"p99Ms\": " << summary.p99Milliseconds << ", \"maxMs\": " << summary.maxMilliseconds
+			<< ", \"avgEntities\": " << summary.averageEntities << ", \"avgAllocations\": " << summary.averageAllocations
+			<< " }" << (i + 1 < summaries.size() ? "," : "") << "\n";
+	}
+	out << "  ]\n}\n";
+}
+
+bool SystemTimings::Save(const std::string& path) const
+{
+	std::ofstream out(path);
+	if (!out)
+	{
+		std::cerr << "Failed to open " << path << " for system timings" << std::endl;
+		return false;
+	}
+	if (path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0)
+	{
+		WriteJson(out);
+	}
+	else
+	{
+		WriteCsv(out);
+	}
+	return true;
+}
@@ -0,0 +1,753 @@
+#include "../include/WorldSnapshot.h"
+#include "../include/ECSManager.h"
+#include "../../core/include/MappedFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+namespace
+{
+	constexpr char Magic[8] = { '3', 'D', 'E', 'W', 'O', 'R', 'L', 'D' };
+	constexpr uint32_t EndianTag = 0x01020304;
+	constexpr size_t SectionAlignment = 64;
+
+	struct Header
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t endianTag;
+		uint32_t handleBytes;
+		uint32_t typeCount;
+		uint32_t recordCount;
+		uint32_t freeCount;
+		uint32_t archetypeCount;
+		uint32_t sparseCount;
+		uint64_t fileSize;
+		uint64_t typesOffset;
+		uint64_t namesOffset;
+		uint64_t generationsOffset;
+		uint64_t freeOffset;
+		uint64_t archetypesOffset;
+		uint64_t sparseOffset;
+	};
+
+	struct TypeEntry
+	{
+		uint32_t nameOffset;
+		uint32_t nameLength;
+		uint32_t size;
+		uint32_t alignment;
+	};
+
+	// Followed in the file by typeCount uint32 type indices, then typeCount uint64
+	// column offsets.
+	struct ArchetypeEntry
+	{
+		uint32_t typeCount;
+		uint32_t padding;
+		uint64_t entityCount;
+		uint64_t entitiesOffset;
+		uint64_t typesOffset;
+		uint64_t columnsOffset;
+	};
+
+	struct SparseEntry
+	{
+		uint32_t type;
+		uint32_t padding;
+		uint64_t count;
+		uint64_t entitiesOffset;
+		uint64_t dataOffset;
+	};
+
+	// Growable output buffer addressed by offset, since appends move the storage.
+	class Writer
+	{
+	public:
+		uint64_t Allocate(size_t size, size_t alignment)
+		{
+			size_t offset = (bytes.size() + alignment - 1) / alignment * alignment;
+			bytes.resize(offset + size);
+			return offset;
+		}
+
+		uint64_t Append(const void* data, size_t size, size_t alignment)
+		{
+			uint64_t offset = Allocate(size, alignment);
+			if (size)
+			{
+				std::memcpy(bytes.data() + offset, data, size);
+			}
+			return offset;
+		}
+
+		template <typename T>
+		T* At(uint64_t offset)
+		{
+			return reinterpret_cast<T*>(bytes.data() + offset);
+		}
+
+		std::vector<std::byte> bytes;
+	};
+
+	// Bounds-checked access to a mapped snapshot.
+	class Reader
+	{
+	public:
+		bool Open(const std::string& path)
+		{
+			if (!file.Open(path) || file.GetSize() < sizeof(Header))
+			{
+				std::cerr << "Failed to open snapshot " << path << std::endl;
+				return false;
+			}
+			header = reinterpret_cast<const Header*>(file.GetData());
+			if (std::memcmp(header->magic, Magic, sizeof(Magic)) != 0 || header->endianTag != EndianTag
+				|| header->handleBytes != sizeof(Entity) || header->fileSize != file.GetSize())
+			{
+				std::cerr << "Snapshot " << path << " is not a compatible world snapshot" << std::endl;
+				return false;
+			}
+			if (header->version != WorldSnapshot::FormatVersion)
+			{
+				std::cerr << "Snapshot " << path << " has format version " << header->version << ", expected "
+					<< WorldSnapshot::FormatVersion << std::endl;
+				return false;
+			}
+			if (!ValidArray(header->typesOffset, header->typeCount, sizeof(TypeEntry))
+				|| !ValidArray(header->generationsOffset, header->recordCount, sizeof(uint32_t))
+				|| !ValidArray(header->freeOffset, header->freeCount, sizeof(uint32_t))
+				|| !ValidArray(header->archetypesOffset, header->archetypeCount, sizeof(ArchetypeEntry))
+				|| !ValidArray(header->sparseOffset, header->sparseCount, sizeof(SparseEntry)))
+			{
+				std::cerr << "Snapshot " << path << " is truncated" << std::endl;
+				return false;
+			}
+			return true;
+		}
+
+		bool Valid(uint64_t offset, uint64_t size) const
+		{
+			return offset <= file.GetSize() && size <= file.GetSize() - offset;
+		}
+
+		// count elements of elementSize bytes at offset, without the product overflowing.
+		bool ValidArray(uint64_t offset, uint64_t count, uint64_t elementSize) const
+		{
+			return offset <= file.GetSize() && (elementSize == 0 || count <= (file.GetSize() - offset) / elementSize);
+		}
+
+		template <typename T>
+		const T* At(uint64_t offset) const
+		{
+			return reinterpret_cast<const T*>(file.GetData() + offset);
+		}
+
+		std::string_view GetTypeName(uint32_t type) const
+		{
+			const TypeEntry& entry = At<TypeEntry>(header->typesOffset)[type];
+			if (!Valid(header->namesOffset + entry.nameOffset, entry.nameLength))
+			{
+				return {};
+			}
+			return std::string_view(At<char>(header->namesOffset + entry.nameOffset), entry.nameLength);
+		}
+
+		// Registered type matching file type index, or InvalidComponentType when the type
+		// is unknown or its layout changed.
+		ComponentTypeId Resolve(uint32_t type) const
+		{
+			if (type >= header->typeCount)
+			{
+				return InvalidComponentType;
+			}
+			const TypeEntry& entry = At<TypeEntry>(header->typesOffset)[type];
+			ComponentTypeId id = ComponentRegistry::Find(GetTypeName(type));
+			if (id == InvalidComponentType)
+			{
+				return id;
+			}
+			const ComponentInfo& info = ComponentRegistry::GetInfo(id);
+			return info.size == entry.size && info.alignment == entry.alignment && info.persistence == ComponentPersistence::Saved ? id : InvalidComponentType;
+		}
+
+		bool ValidArchetype(const ArchetypeEntry& entry) const
+		{
+			return ValidArray(entry.entitiesOffset, entry.entityCount, sizeof(Entity))
+				&& ValidArray(entry.typesOffset, entry.typeCount, sizeof(uint32_t))
+				&& ValidArray(entry.columnsOffset, entry.typeCount, sizeof(uint64_t));
+		}
+
+		bool ValidColumn(uint32_t type, uint64_t offset, uint64_t count) const
+		{
+			return type < header->typeCount && ValidArray(offset, count, At<TypeEntry>(header->typesOffset)[type].size);
+		}
+
+		MappedFile file;
+		const Header* header = nullptr;
+	};
+
+	// Entity handle to component bytes for one type, gathered from every archetype and
+	// sparse pool of a snapshot.
+	using ComponentIndex = std::unordered_map<Entity::HandleType, const std::byte*>;
+
+	void IndexSnapshot(const Reader& reader, std::unordered_map<std::string_view, ComponentIndex>& components,
+		std::vector<Entity::HandleType>& entities)
+	{
+		const Header& header = *reader.header;
+		for (uint32_t a = 0; a < header.archetypeCount; ++a)
+		{
+			const ArchetypeEntry& entry = reader.At<ArchetypeEntry>(header.archetypesOffset)[a];
+			if (!reader.ValidArchetype(entry))
+			{
+				continue;
+			}
+			const Entity* rows = reader.At<Entity>(entry.entitiesOffset);
+			for (uint64_t row = 0; row < entry.entityCount; ++row)
+			{
+				entities.push_back(rows[row].GetHandle());
+			}
+			for (uint32_t column = 0; column < entry.typeCount; ++column)
+			{
+				uint32_t type = reader.At<uint32_t>(entry.typesOffset)[column];
+				uint64_t offset = reader.At<uint64_t>(entry.columnsOffset)[column];
+				if (!reader.ValidColumn(type, offset, entry.entityCount))
+				{
+					continue;
+				}
+				size_t size = reader.At<TypeEntry>(header.typesOffset)[type].size;
+				ComponentIndex& index = components[reader.GetTypeName(type)];
+				for (uint64_t row = 0; row < entry.entityCount; ++row)
+				{
+					index[rows[row].GetHandle()] = reader.At<std::byte>(offset + row * size);
+				}
+			}
+		}
+		for (uint32_t s = 0; s < header.sparseCount; ++s)
+		{
+			const SparseEntry& entry = reader.At<SparseEntry>(header.sparseOffset)[s];
+			if (!reader.ValidArray(entry.entitiesOffset, entry.count, sizeof(Entity)) || !reader.ValidColumn(entry.type, entry.dataOffset, entry.count))
+			{
+				continue;
+			}
+			size_t size = reader.At<TypeEntry>(header.typesOffset)[entry.type].size;
+			ComponentIndex& index = components[reader.GetTypeName(entry.type)];
+			const Entity* rows = reader.At<Entity>(entry.entitiesOffset);
+			for (uint64_t row = 0; row < entry.count; ++row)
+			{
+				index[rows[row].GetHandle()] = reader.At<std::byte>(entry.dataOffset + row * size);
+			}
+		}
+		std::sort(entities.begin(), entities.end());
+	}
+
+	// Checks everything Load relies on, so a corrupt file is rejected before the world is
+	// touched: section bounds, type indices, that every stored handle names a slot with
+	// its saved generation, that no slot is both live and free or live twice, and that
+	// sparse entries only refer to live entities.
+	bool ValidateForLoad(const Reader& reader, const std::vector<ComponentTypeId>& resolved)
+	{
+		const Header& header = *reader.header;
+		const uint32_t* generations = reader.At<uint32_t>(header.generationsOffset);
+		enum : uint8_t { Unused, Live, Free };
+		std::vector<uint8_t> slots(header.recordCount, Unused);
+		auto matches = [&](Entity entity)
+		{
+			return entity.GetId() < header.recordCount && generations[entity.GetId()] == entity.GetGeneration();
+		};
+
+		for (uint32_t a = 0; a < header.archetypeCount; ++a)
+		{
+			const ArchetypeEntry& entry = reader.At<ArchetypeEntry>(header.archetypesOffset)[a];
+			if (!reader.ValidArchetype(entry))
+			{
+				return false;
+			}
+			for (uint32_t column = 0; column < entry.typeCount; ++column)
+			{
+				const uint32_t type = reader.At<uint32_t>(entry.typesOffset)[column];
+				const uint64_t offset = reader.At<uint64_t>(entry.columnsOffset)[column];
+				if (!reader.ValidColumn(type, offset, entry.entityCount))
+				{
+					return false;
+				}
+			}
+			const Entity* entities = reader.At<Entity>(entry.entitiesOffset);
+			for (uint64_t row = 0; row < entry.entityCount; ++row)
+			{
+				if (!matches(entities[row]) || slots[entities[row].GetId()] != Unused)
+				{
+					return false;
+				}
+				slots[entities[row].GetId()] = Live;
+			}
+		}
+
+		const uint32_t* freeIndices = reader.At<uint32_t>(header.freeOffset);
+		for (uint32_t i = 0; i < header.freeCount; ++i)
+		{
+			if (freeIndices[i] >= header.recordCount || slots[freeIndices[i]] != Unused)
+			{
+				return false;
+			}
+			slots[freeIndices[i]] = Free;
+		}
+
+		for (uint32_t s = 0; s < header.sparseCount; ++s)
+		{
+			const SparseEntry& entry = reader.At<SparseEntry>(header.sparseOffset)[s];
+			if (!reader.ValidArray(entry.entitiesOffset, entry.count, sizeof(Entity)) || !reader.ValidColumn(entry.type, entry.dataOffset, entry.count))
+			{
+				return false;
+			}
+			if (resolved[entry.type] == InvalidComponentType)
+			{
+				continue;
+			}
+			const Entity* entities = reader.At<Entity>(entry.entitiesOffset);
+			for (uint64_t row = 0; row < entry.count; ++row)
+			{
+				if (!matches(entities[row]) || slots[entities[row].GetId()] != Live)
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+}
+
+bool WorldSnapshot::Save(const ECSManager& world, const std::string& path)
+{
+	// File type table: every persistent type in use, sorted by name.
+	std::vector<ComponentTypeId> types;
+	Signature used;
+	for (const Archetype* archetype : world.archetypes)
+	{
+		if (archetype->GetEntityCount() > 0)
+		{
+			used |= archetype->GetSignature();
+		}
+	}
+	for (ComponentTypeId type = 0; type < MaxComponentTypes; ++type)
+	{
+		if (world.sparseSets[type] && world.sparseSets[type]->Size() > 0)
+		{
+			used.set(type);
+		}
+	}
+
+	// Tags are written as sparse entries: the tagged entities plus one zeroed byte each,
+	// so loading and diffing need no separate section.
+	std::array<std::vector<Entity>, MaxComponentTypes> tagged;
+	for (const Archetype* archetype : world.archetypes)
+	{
+		for (ComponentTypeId tag : archetype->GetTagTypes())
+		{
+			for (size_t c = 0; c < archetype->GetChunkCount(); ++c)
+			{
+				const Entity* entities = archetype->GetEntities(archetype->GetChunk(c));
+				for (uint32_t row = 0; row < archetype->GetChunk(c).count; ++row)
+				{
+					if (archetype->HasTag(tag, static_cast<uint32_t>(c), row))
+					{
+						tagged[tag].push_back(entities[row]);
+					}
+				}
+			}
+		}
+	}
+	for (ComponentTypeId type = 0; type < MaxComponentTypes; ++type)
+	{
+		if (!tagged[type].empty())
+		{
+			used.set(type);
+		}
+	}
+	for (ComponentTypeId type = 0; type < ComponentRegistry::GetCount(); ++type)
+	{
+		if (!used.test(type))
+		{
+			continue;
+		}
+		const ComponentInfo& info = ComponentRegistry::GetInfo(type);
+		if (info.persistence == ComponentPersistence::Undeclared)
+		{
+			std::cerr << "Snapshot cannot save " << info.name << ": declare whether it is Persistent" << std::endl;
+			return false;
+		}
+		if (info.persistence == ComponentPersistence::Saved)
+		{
+			types.push_back(type);
+		}
+	}
+	std::sort(types.begin(), types.end(), [](ComponentTypeId a, ComponentTypeId b)
+	{
+		return ComponentRegistry::GetInfo(a).name < ComponentRegistry::GetInfo(b).name;
+	});
+	std::array<uint32_t, MaxComponentTypes> fileType;
+	fileType.fill(UINT32_MAX);
+	for (uint32_t i = 0; i < types.size(); ++i)
+	{
+		fileType[types[i]] = i;
+	}
+
+	// Stored column lists in file type order; archetypes sorted by them.
+	struct Source
+	{
+		const Archetype* archetype;
+		std::vector<uint32_t> fileTypes;
+	};
+	std::vector<Source> sources;
+	for (const Archetype* archetype : world.archetypes)
+	{
+		if (archetype->GetEntityCount() == 0)
+		{
+			continue;
+		}
+		Source source{ archetype, {} };
+		for (ComponentTypeId type : archetype->GetTypes())
+		{
+			if (fileType[type] != UINT32_MAX)
+			{
+				source.fileTypes.push_back(fileType[type]);
+			}
+		}
+		std::sort(source.fileTypes.begin(), source.fileTypes.end());
+		sources.push_back(std::move(source));
+	}
+	std::stable_sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) { return a.fileTypes < b.fileTypes; });
+
+	std::vector<ComponentTypeId> sparseTypes;
+	for (ComponentTypeId type : types)
+	{
+		if ((world.sparseSets[type] && world.sparseSets[type]->Size() > 0) || !tagged[type].empty())
+		{
+			sparseTypes.push_back(type);
+		}
+	}
+
+	Writer writer;
+	writer.Allocate(sizeof(Header), SectionAlignment);
+	Header header = {};
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = FormatVersion;
+	header.endianTag = EndianTag;
+	header.handleBytes = sizeof(Entity);
+	header.typeCount = static_cast<uint32_t>(types.size());
+	header.recordCount = static_cast<uint32_t>(world.entityRecords.size());
+	header.freeCount = static_cast<uint32_t>(world.freeIndices.size());
+	header.archetypeCount = static_cast<uint32_t>(sources.size());
+	header.sparseCount = static_cast<uint32_t>(sparseTypes.size());
+
+	std::string names;
+	std::vector<TypeEntry> typeEntries;
+	for (ComponentTypeId type : types)
+	{
+		const ComponentInfo& info = ComponentRegistry::GetInfo(type);
+		typeEntries.push_back({ static_cast<uint32_t>(names.size()), static_cast<uint32_t>(info.name.size()),
+			static_cast<uint32_t>(info.size), static_cast<uint32_t>(info.alignment) });
+		names += info.name;
+	}
+	header.typesOffset = writer.Append(typeEntries.data(), typeEntries.size() * sizeof(TypeEntry), SectionAlignment);
+	header.namesOffset = writer.Append(names.data(), names.size(), 1);
+
+	header.generationsOffset = writer.Allocate(world.entityRecords.size() * sizeof(uint32_t), SectionAlignment);
+	for (size_t index = 0; index < world.entityRecords.size(); ++index)
+	{
+		writer.At<uint32_t>(header.generationsOffset)[index] = world.entityRecords[index].generation;
+	}
+	header.freeOffset = writer.Append(world.freeIndices.data(), world.freeIndices.size() * sizeof(uint32_t), SectionAlignment);
+
+	header.archetypesOffset = writer.Allocate(sources.size() * sizeof(ArchetypeEntry), SectionAlignment);
+	for (size_t a = 0; a < sources.size(); ++a)
+	{
+		const Archetype& archetype = *sources[a].archetype;
+		const std::vector<uint32_t>& fileTypes = sources[a].fileTypes;
+		const size_t count = archetype.GetEntityCount();
+
+		ArchetypeEntry entry = {};
+		entry.typeCount = static_cast<uint32_t>(fileTypes.size());
+		entry.entityCount = count;
+		entry.typesOffset = writer.Append(fileTypes.data(), fileTypes.size() * sizeof(uint32_t), alignof(uint64_t));
+		entry.columnsOffset = writer.Allocate(fileTypes.size() * sizeof(uint64_t), alignof(uint64_t));
+
+		entry.entitiesOffset = writer.Allocate(count * sizeof(Entity), SectionAlignment);
+		size_t row = 0;
+		for (size_t c = 0; c < archetype.GetChunkCount(); ++c)
+		{
+			const Archetype::Chunk& chunk = archetype.GetChunk(c);
+			std::memcpy(writer.At<std::byte>(entry.entitiesOffset + row * sizeof(Entity)), archetype.GetEntities(chunk), chunk.count * sizeof(Entity));
+			row += chunk.count;
+		}
+
+		for (size_t column = 0; column < fileTypes.size(); ++column)
+		{
+			const ComponentTypeId type = types[fileTypes[column]];
+			const int source = archetype.FindColumn(type);
+			const size_t size = archetype.GetComponents()[source].size;
+			uint64_t offset = writer.Allocate(count * size, SectionAlignment);
+			writer.At<uint64_t>(entry.columnsOffset)[column] = offset;
+			for (size_t c = 0; c < archetype.GetChunkCount(); ++c)
+			{
+				const Archetype::Chunk& chunk = archetype.GetChunk(c);
+				std::memcpy(writer.At<std::byte>(offset), archetype.GetColumn(chunk, source), chunk.count * size);
+				offset += chunk.count * size;
+			}
+		}
+		*writer.At<ArchetypeEntry>(header.archetypesOffset + a * sizeof(ArchetypeEntry)) = entry;
+	}
+
+	header.sparseOffset = writer.Allocate(sparseTypes.size() * sizeof(SparseEntry), SectionAlignment);
+	for (size_t s = 0; s < sparseTypes.size(); ++s)
+	{
+		const ComponentTypeId type = sparseTypes[s];
+		SparseEntry entry = {};
+		entry.type = fileType[type];
+		if (ComponentRegistry::GetInfo(type).tag)
+		{
+			entry.count = tagged[type].size();
+			entry.entitiesOffset = writer.Append(tagged[type].data(), tagged[type].size() * sizeof(Entity), SectionAlignment);
+			entry.dataOffset = writer.Allocate(tagged[type].size() * ComponentRegistry::GetInfo(type).size, SectionAlignment);
+		}
+		else
+		{
+			const SparseSetBase& pool = *world.sparseSets[type];
+			entry.count = pool.Size();
+			entry.entitiesOffset = writer.Append(pool.GetEntityData(), pool.Size() * sizeof(Entity), SectionAlignment);
+			entry.dataOffset = writer.Append(pool.GetComponentData(), pool.Size() * ComponentRegistry::GetInfo(type).size, SectionAlignment);
+		}
+		*writer.At<SparseEntry>(header.sparseOffset + s * sizeof(SparseEntry)) = entry;
+	}
+
+	header.fileSize = writer.bytes.size();
+	*writer.At<Header>(0) = header;
+
+	std::FILE* file = std::fopen(path.c_str(), "wb");
+	if (!file)
+	{
+		std::cerr << "Failed to open " << path << " for writing" << std::endl;
+		return false;
+	}
+	bool written = std::fwrite(writer.bytes.data(), 1, writer.bytes.size(), file) == writer.bytes.size();
+	written = std::fclose(file) == 0 && written;
+	if (!written)
+	{
+		std::cerr << "Failed to write snapshot " << path << std::endl;
+	}
+	return written;
+}
+
+bool WorldSnapshot::Load(ECSManager& world, const std::string& path)
+{
+	Reader reader;
+	if (!reader.Open(path))
+	{
+		return false;
+	}
+	const Header& header = *reader.header;
+
+	std::vector<ComponentTypeId> resolved(header.typeCount);
+	for (uint32_t type = 0; type < header.typeCount; ++type)
+	{
+		resolved[type] = reader.Resolve(type);
+		if (resolved[type] == InvalidComponentType)
+		{
+			std::cerr << "Snapshot drops " << reader.GetTypeName(type) << ": type unknown or layout changed" << std::endl;
+		}
+	}
+	if (!ValidateForLoad(reader, resolved))
+	{
+		std::cerr << "Snapshot " << path << " is corrupt" << std::endl;
+		return false;
+	}
+
+	// Clear the world, then restore slots with their saved generations.
+	for (Entity::IdType index = 0; index < world.entityRecords.size(); ++index)
+	{
+		if (world.entityRecords[index].archetype)
+		{
+			world.DestroyEntity(Entity(index, world.entityRecords[index].generation));
+		}
+	}
+	for (auto& pool : world.sparseSets)
+	{
+		pool.reset();
+	}
+	world.entityRecords.assign(header.recordCount, ECSManager::EntityRecord());
+	const uint32_t* generations = reader.At<uint32_t>(header.generationsOffset);
+	for (uint32_t index = 0; index < header.recordCount; ++index)
+	{
+		world.entityRecords[index].generation = generations[index];
+	}
+	const uint32_t* freeIndices = reader.At<uint32_t>(header.freeOffset);
+	world.freeIndices.assign(freeIndices, freeIndices + header.freeCount);
+	world.dirtyEntities.clear();
+	world.membershipStale = true;
+
+	const uint32_t version = world.GetChangeVersion();
+	for (uint32_t a = 0; a < header.archetypeCount; ++a)
+	{
+		const ArchetypeEntry& entry = reader.At<ArchetypeEntry>(header.archetypesOffset)[a];
+		Signature signature;
+		std::array<const std::byte*, MaxComponentTypes> columns = {};
+		for (uint32_t column = 0; column < entry.typeCount; ++column)
+		{
+			uint32_t type = reader.At<uint32_t>(entry.typesOffset)[column];
+			uint64_t offset = reader.At<uint64_t>(entry.columnsOffset)[column];
+			if (resolved[type] == InvalidComponentType)
+			{
+				continue;
+			}
+			signature.set(resolved[type]);
+			columns[resolved[type]] = reader.At<std::byte>(offset);
+		}
+
+		// Copy entity handles and whole column slices a chunk at a time.
+		Archetype* archetype = world.GetOrCreateArchetype(signature);
+		const Entity* entities = reader.At<Entity>(entry.entitiesOffset);
+		uint64_t loaded = 0;
+		while (loaded < entry.entityCount)
+		{
+			Archetype::RowRange rows = archetype->AllocateRows(entry.entityCount - loaded, version);
+			const Archetype::Chunk& chunk = archetype->GetChunk(rows.chunk);
+			std::memcpy(archetype->GetEntities(chunk) + rows.first, entities + loaded, rows.count * sizeof(Entity));
+			for (uint32_t row = 0; row < rows.count; ++row)
+			{
+				ECSManager::EntityRecord& record = world.entityRecords[entities[loaded + row].GetId()];
+				record.archetype = archetype;
+				record.chunk = rows.chunk;
+				record.row = rows.first + row;
+			}
+			for (size_t column = 0; column < archetype->GetTypes().size(); ++column)
+			{
+				const size_t size = archetype->GetComponents()[column].size;
+				std::memcpy(static_cast<std::byte*>(archetype->GetColumn(chunk, column)) + rows.first * size,
+					columns[archetype->GetTypes()[column]] + loaded * size, rows.count * size);
+			}
+			loaded += rows.count;
+		}
+	}
+
+	for (uint32_t s = 0; s < header.sparseCount; ++s)
+	{
+		const SparseEntry& entry = reader.At<SparseEntry>(header.sparseOffset)[s];
+		const ComponentTypeId type = resolved[entry.type];
+		if (type == InvalidComponentType)
+		{
+			continue;
+		}
+		if (ComponentRegistry::GetInfo(type).tag)
+		{
+			const Entity* entities = reader.At<Entity>(entry.entitiesOffset);
+			for (uint64_t row = 0; row < entry.count; ++row)
+			{
+				if (const ECSManager::EntityRecord* record = world.FindRecord(entities[row]))
+				{
+					record->archetype->SetTag(type, record->chunk, record->row, true);
+				}
+			}
+			continue;
+		}
+		if (!ComponentRegistry::GetInfo(type).createSparseSet)
+		{
+			continue;
+		}
+		auto& pool = world.sparseSets[type];
+		pool.reset(ComponentRegistry::GetInfo(type).createSparseSet());
+		pool->Reserve(entry.count);
+		const Entity* entities = reader.At<Entity>(entry.entitiesOffset);
+		const size_t size = ComponentRegistry::GetInfo(type).size;
+		for (uint64_t row = 0; row < entry.count; ++row)
+		{
+			pool->EmplaceCopied(entities[row], reader.At<std::byte>(entry.dataOffset + row * size));
+		}
+	}
+	return true;
+}
+
+bool WorldSnapshot::Diff(const std::string& before, const std::string& after, std::ostream& out)
+{
+	Reader readers[2];
+	if (!readers[0].Open(before) || !readers[1].Open(after))
+	{
+		return false;
+	}
+
+	std::unordered_map<std::string_view, ComponentIndex> components[2];
+	std::vector<Entity::HandleType> entities[2];
+	for (int i = 0; i < 2; ++i)
+	{
+		IndexSnapshot(readers[i], components[i], entities[i]);
+	}
+
+	std::vector<Entity::HandleType> added;
+	std::vector<Entity::HandleType> removed;
+	std::set_difference(entities[1].begin(), entities[1].end(), entities[0].begin(), entities[0].end(), std::back_inserter(added));
+	std::set_difference(entities[0].begin(), entities[0].end(), entities[1].begin(), entities[1].end(), std::back_inserter(removed));
+	out << "Entities: " << entities[0].size() << " -> " << entities[1].size() << " (" << added.size() << " added, "
+		<< removed.size() << " removed)\n";
+
+	std::vector<std::string_view> names;
+	for (int i = 0; i < 2; ++i)
+	{
+		for (const auto& [name, index] : components[i])
+		{
+			names.push_back(name);
+		}
+	}
+	std::sort(names.begin(), names.end());
+	names.erase(std::unique(names.begin(), names.end()), names.end());
+
+	for (std::string_view name : names)
+	{
+		static const ComponentIndex empty;
+		auto find = [&](int i) -> const ComponentIndex&
+		{
+			auto it = components[i].find(name);
+			return it != components[i].end() ? it->second : empty;
+		};
+		const ComponentIndex& first = find(0);
+		const ComponentIndex& second = find(1);
+
+		// A type whose size changed between the files counts as changed everywhere.
+		size_t sizes[2] = {};
+		for (int i = 0; i < 2; ++i)
+		{
+			for (uint32_t type = 0; type < readers[i].header->typeCount; ++type)
+			{
+				if (readers[i].GetTypeName(type) == name)
+				{
+					sizes[i] = readers[i].At<TypeEntry>(readers[i].header->typesOffset)[type].size;
+				}
+			}
+		}
+
+		size_t gained = 0;
+		size_t lost = 0;
+		size_t changed = 0;
+		for (const auto& [handle, data] : second)
+		{
+			auto it = first.find(handle);
+			if (it == first.end())
+			{
+				++gained;
+			}
+			else if (sizes[0] != sizes[1] || std::memcmp(it->second, data, sizes[0]) != 0)
+			{
+				++changed;
+			}
+		}
+		for (const auto& [handle, data] : first)
+		{
+			lost += second.find(handle) == second.end();
+		}
+		if (gained || lost || changed)
+		{
+			out << "  " << name << ": " << gained << " added, " << lost << " removed, " << changed << " changed\n";
+		}
+	}
+	return true;
+}
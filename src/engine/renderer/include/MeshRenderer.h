@@ -1,12 +1,18 @@
 #pragma once
 
+#include "../../core/include/Math.h"
 #include "../../ecs/include/Component.h"
 #include "../include/OpenGLRenderer.h"
 
 struct MeshRenderer : public Component {
+  // Refers to the live renderer, so it is rebuilt rather than saved.
+  static constexpr bool Persistent = false;
+
   MeshRenderer(OpenGLRenderer& renderer) : renderer(renderer) {}
 
-  void Render() {
+  // Draws with world as the model matrix.
+  void Render(const Mat4& world) const {
+    renderer.SetModelMatrix(world);
     renderer.RenderImpl();
   }
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Renderer.h"
+#include "../../core/include/Math.h"
+#include "../../core/include/Profiler.h"
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
@@ -10,6 +12,7 @@ class OpenGLRenderer : public Renderer<OpenGLRenderer>
 public:
 	void InitializeImpl()
 	{
+		PROFILE_ZONE("OpenGLRenderer::Initialize");
 		if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
 		{
 			std::cerr << "Failed to initialise GLAD" << std::endl;
@@ -21,11 +24,20 @@ public:
 
 	void RenderImpl()
 	{
+		PROFILE_ZONE("OpenGLRenderer::Render");
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	}
 
 	void ShutdownImpl()
 	{
+		PROFILE_ZONE("OpenGLRenderer::Shutdown");
 		std::cout << "OpenGL Renderer shutdown." << std::endl;
 	}
+
+	// Model matrix for the next draw.
+	void SetModelMatrix(const Mat4& matrix) { modelMatrix = matrix; }
+	const Mat4& GetModelMatrix() const { return modelMatrix; }
+
+private:
+	Mat4 modelMatrix;
 };
\ No newline at end of file
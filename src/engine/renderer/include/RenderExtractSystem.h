@@ -0,0 +1,42 @@
+#pragma once
+
+#include "../../ecs/include/ECSManager.h"
+#include "../../ecs/include/System.h"
+#include "../../scene/include/Transform.h"
+#include "MeshRenderer.h"
+#include "RenderFrame.h"
+
+// Extract point for threaded rendering: copies every mesh with its world matrix into the
+// back RenderFrame and publishes it for the render thread. Used in place of RenderSystem.
+// Meshes are picked up once TransformSystem has given them a WorldTransform.
+class RenderExtractSystem : public System
+{
+public:
+	explicit RenderExtractSystem(RenderFrames& frames) : frames(frames)
+	{
+		Reads<MeshRenderer, WorldTransform>();
+	}
+
+	const char* GetName() const override { return "RenderExtractSystem"; }
+
+	void Update(float) override
+	{
+		Extract(1.0f);
+	}
+
+	// Publishes one frame. With a GameLoop, call once per frame rather than per
+	// simulation step, passing GetAlpha for the render thread to blend with.
+	void Extract(float alpha)
+	{
+		RenderFrame& frame = frames.BeginExtract();
+		frame.alpha = alpha;
+		ecsManager->Each<const MeshRenderer, const WorldTransform>([&](Entity, const MeshRenderer& mesh, const WorldTransform& world)
+		{
+			frame.items.push_back({ mesh, world.matrix, world.previous });
+		});
+		frames.EndExtract();
+	}
+
+private:
+	RenderFrames& frames;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "../../core/include/Math.h"
+#include "../../core/include/MemoryTracker.h"
+#include "MeshRenderer.h"
+
+// One mesh to draw, copied out of the world so the renderer never reads live components.
+// Carries the last two simulation steps' matrices for the renderer to blend.
+struct RenderItem
+{
+	MeshRenderer mesh;
+	Mat4 world;
+	Mat4 previous;
+};
+
+// Everything the renderer needs for one simulated frame. Immutable once published.
+struct RenderFrame
+{
+	uint64_t index = 0;
+	// GameLoop interpolation factor the frame was extracted at.
+	float alpha = 1.0f;
+	TrackedVector<RenderItem, MemoryTag::Renderer> items;
+};
+
+// Double buffer between simulation and a render thread. The simulation extracts frame
+// N + 1 into the back frame while the render thread draws frame N from the front one;
+// EndExtract and Acquire are the only hand-off points. BeginExtract waits until the render
+// thread has acquired the last published frame, so every frame is drawn and the
+// simulation runs at most one frame ahead, paced by the render thread's presents.
+class RenderFrames
+{
+public:
+	// Simulation side: the frame to fill, cleared of the items it held before. Blocks
+	// while the previous frame is still waiting to be acquired.
+	RenderFrame& BeginExtract();
+	// Publishes the frame returned by BeginExtract.
+	void EndExtract();
+
+	// Render side: waits for a frame newer than the last one acquired. Returns null once
+	// Stop has been called. The frame stays valid until Release.
+	const RenderFrame* Acquire();
+	void Release();
+
+	// Wakes both sides and makes Acquire return null.
+	void Stop();
+
+private:
+	RenderFrame frames[2];
+	int writing = -1;
+	int published = -1;
+	int reading = -1;
+	int lastWritten = 1;
+	uint64_t nextIndex = 0;
+	bool stopped = false;
+	std::mutex mutex;
+	std::condition_variable changed;
+};
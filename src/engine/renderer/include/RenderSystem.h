@@ -1,21 +1,37 @@
 #pragma once
 
+#include "../../core/include/Profiler.h"
+#include "../../ecs/include/ECSManager.h"
 #include "../../ecs/include/System.h"
+#include "../../scene/include/Transform.h"
 #include "MeshRenderer.h"
 #include <vector>
 
 class RenderSystem : public System
 {
 public:
-	void Update(float deltaTime) override
+	RenderSystem()
 	{
-		for (auto entity : entities)
+		Reads<MeshRenderer, WorldTransform>();
+		RunOnMainThread();
+	}
+
+	const char* GetName() const override { return "RenderSystem"; }
+
+	void Update(float) override
+	{
+		Render(1.0f);
+	}
+
+	// Draws every mesh at its world matrix blended between the last two steps. With a
+	// GameLoop, call once per frame rather than per simulation step, passing GetAlpha.
+	// Meshes are picked up once TransformSystem has given them a WorldTransform.
+	void Render(float alpha)
+	{
+		PROFILE_ZONE("RenderSystem::Render");
+		ecsManager->Each<const MeshRenderer, const WorldTransform>([alpha](Entity, const MeshRenderer& mesh, const WorldTransform& world)
 		{
-			auto meshRenderer = entity.GetComponent<MeshRenderer>();
-			if (meshRenderer)
-			{
-				meshRenderer->Render();
-			}
-		}
+			mesh.Render(world.GetInterpolated(alpha));
+		});
 	}
-};
\ No newline at end of file
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "RenderFrame.h"
+
+struct GLFWwindow;
+
+// Draws frames published to a RenderFrames on a thread of its own and presents them.
+// The thread owns the window's GL context while it runs, so release the context on the
+// calling thread before Start and make it current again after Stop.
+class RenderThread
+{
+public:
+	RenderThread(GLFWwindow* window, RenderFrames& frames);
+	~RenderThread();
+
+	RenderThread(const RenderThread&) = delete;
+	RenderThread& operator=(const RenderThread&) = delete;
+
+	void Start();
+	// Stops the frame exchange and joins the thread.
+	void Stop();
+
+	// Framebuffer resizes arrive on the event thread; the viewport is updated before the
+	// next frame is drawn.
+	void Resize(int width, int height);
+
+	uint64_t GetFramesDrawn() const { return framesDrawn.load(std::memory_order_relaxed); }
+
+private:
+	void Loop();
+
+	GLFWwindow* window;
+	RenderFrames& frames;
+	std::thread thread;
+	std::atomic<uint64_t> pendingSize{ 0 };
+	std::atomic<uint64_t> framesDrawn{ 0 };
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "../../core/include/FrameTelemetry.h"
+
+struct GLFWwindow;
+
+// Nuklear window over the scene with frame time percentiles, hitch counts and a graph of
+// the recent frames per phase. Uses nuklear's GL2 backend, which keeps global state, so
+// create at most one, on the thread owning the window's context.
+class TelemetryOverlay
+{
+public:
+	explicit TelemetryOverlay(GLFWwindow* window);
+	~TelemetryOverlay();
+
+	TelemetryOverlay(const TelemetryOverlay&) = delete;
+	TelemetryOverlay& operator=(const TelemetryOverlay&) = delete;
+
+	// Draws on top of the current frame; call after the scene, before swapping.
+	void Draw(const FrameTelemetry& telemetry);
+
+private:
+	struct nk_context* context = nullptr;
+};
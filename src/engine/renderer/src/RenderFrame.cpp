@@ -0,0 +1,55 @@
+#include "../include/RenderFrame.h"
+
+RenderFrame& RenderFrames::BeginExtract()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	const int target = 1 - lastWritten;
+	changed.wait(lock, [&] { return (published < 0 && reading != target) || stopped; });
+	writing = target;
+	RenderFrame& frame = frames[target];
+	frame.index = nextIndex++;
+	frame.items.clear();
+	return frame;
+}
+
+void RenderFrames::EndExtract()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		published = writing;
+		lastWritten = writing;
+		writing = -1;
+	}
+	changed.notify_all();
+}
+
+const RenderFrame* RenderFrames::Acquire()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	changed.wait(lock, [&] { return published >= 0 || stopped; });
+	if (stopped)
+	{
+		return nullptr;
+	}
+	reading = published;
+	published = -1;
+	return &frames[reading];
+}
+
+void RenderFrames::Release()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		reading = -1;
+	}
+	changed.notify_all();
+}
+
+void RenderFrames::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopped = true;
+	}
+	changed.notify_all();
+}
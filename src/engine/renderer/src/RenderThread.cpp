@@ -0,0 +1,67 @@
+#include "../include/RenderThread.h"
+#include "../../core/include/Profiler.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+namespace
+{
+	constexpr uint64_t NoResize = 0;
+
+	uint64_t PackSize(int width, int height)
+	{
+		return (uint64_t(uint32_t(width)) << 32 | uint32_t(height)) + 1;
+	}
+}
+
+RenderThread::RenderThread(GLFWwindow* window, RenderFrames& frames)
+	: window(window), frames(frames)
+{
+}
+
+RenderThread::~RenderThread()
+{
+	Stop();
+}
+
+void RenderThread::Start()
+{
+	thread = std::thread([this] { Loop(); });
+}
+
+void RenderThread::Stop()
+{
+	frames.Stop();
+	if (thread.joinable())
+	{
+		thread.join();
+	}
+}
+
+void RenderThread::Resize(int width, int height)
+{
+	pendingSize.store(PackSize(width, height), std::memory_order_relaxed);
+}
+
+void RenderThread::Loop()
+{
+	Profiler::SetThreadName("Render");
+	glfwMakeContextCurrent(window);
+	while (const RenderFrame* frame = frames.Acquire())
+	{
+		PROFILE_ZONE("RenderThread::Frame");
+		uint64_t size = pendingSize.exchange(NoResize, std::memory_order_relaxed);
+		if (size != NoResize)
+		{
+			--size;
+			glViewport(0, 0, static_cast<GLsizei>(size >> 32), static_cast<GLsizei>(size & 0xffffffff));
+		}
+		for (const RenderItem& item : frame->items)
+		{
+			item.mesh.Render(Lerp(item.previous, item.world, frame->alpha));
+		}
+		frames.Release();
+		glfwSwapBuffers(window);
+		framesDrawn.fetch_add(1, std::memory_order_relaxed);
+	}
+	glfwMakeContextCurrent(nullptr);
+}
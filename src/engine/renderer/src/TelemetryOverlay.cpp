@@ -0,0 +1,109 @@
+#include "../include/TelemetryOverlay.h"
+#include "../../core/include/Profiler.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <algorithm>
+
+#define NK_INCLUDE_FIXED_TYPES
+#define NK_INCLUDE_STANDARD_IO
+#define NK_INCLUDE_STANDARD_VARARGS
+#define NK_INCLUDE_DEFAULT_ALLOCATOR
+#define NK_INCLUDE_VERTEX_BUFFER_OUTPUT
+#define NK_INCLUDE_FONT_BAKING
+#define NK_INCLUDE_DEFAULT_FONT
+#define NK_IMPLEMENTATION
+#define NK_GLFW_GL2_IMPLEMENTATION
+// Nuklear predates C++20, which deprecates mixing its enum types in flag expressions.
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-enum-enum-conversion"
+#endif
+#include "../../../../deps/glfw/deps/nuklear.h"
+#include "../../../../deps/glfw/deps/nuklear_glfw_gl2.h"
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace
+{
+	struct PhaseStyle
+	{
+		FrameTelemetry::Phase phase;
+		const char* name;
+		nk_color color;
+	};
+
+	const PhaseStyle Phases[] = {
+		{ FrameTelemetry::Phase::Simulate, "Simulate", { 90, 200, 90, 255 } },
+		{ FrameTelemetry::Phase::Render, "Render", { 90, 150, 230, 255 } },
+		{ FrameTelemetry::Phase::Swap, "Swap", { 230, 180, 60, 255 } },
+		{ FrameTelemetry::Phase::Total, "Total", { 230, 230, 230, 255 } },
+	};
+}
+
+TelemetryOverlay::TelemetryOverlay(GLFWwindow* window)
+{
+	context = nk_glfw3_init(window, NK_GLFW3_INSTALL_CALLBACKS);
+	struct nk_font_atlas* atlas;
+	nk_glfw3_font_stash_begin(&atlas);
+	nk_glfw3_font_stash_end();
+}
+
+TelemetryOverlay::~TelemetryOverlay()
+{
+	nk_glfw3_shutdown();
+}
+
+void TelemetryOverlay::Draw(const FrameTelemetry& telemetry)
+{
+	PROFILE_ZONE("TelemetryOverlay::Draw");
+	nk_glfw3_new_frame();
+	if (nk_begin(context, "Frame telemetry", nk_rect(10, 10, 340, 300),
+		NK_WINDOW_BORDER | NK_WINDOW_MOVABLE | NK_WINDOW_SCALABLE | NK_WINDOW_MINIMIZABLE | NK_WINDOW_TITLE))
+	{
+		nk_layout_row_dynamic(context, 16, 1);
+		nk_labelf(context, NK_TEXT_LEFT, "%zu frames, hitches over %.1f ms: %zu (%llu total)", telemetry.GetCount(),
+			telemetry.GetHitchMilliseconds(), telemetry.GetHitchCount(), static_cast<unsigned long long>(telemetry.GetTotalHitchCount()));
+		nk_layout_row_dynamic(context, 16, 5);
+		for (const char* heading : { "ms", "avg", "p50", "p95", "p99" })
+		{
+			nk_label(context, heading, NK_TEXT_RIGHT);
+		}
+		for (const PhaseStyle& style : Phases)
+		{
+			nk_label_colored(context, style.name, NK_TEXT_LEFT, style.color);
+			nk_labelf(context, NK_TEXT_RIGHT, "%.2f", telemetry.GetAverage(style.phase));
+			for (float percentile : { 50.0f, 95.0f, 99.0f })
+			{
+				nk_labelf(context, NK_TEXT_RIGHT, "%.1f", telemetry.GetPercentile(style.phase, percentile));
+			}
+		}
+
+		// Scaled to the slowest recent frame, but never below the hitch threshold.
+		const int count = static_cast<int>(telemetry.GetCount());
+		float maxMilliseconds = telemetry.GetHitchMilliseconds();
+		for (int i = 0; i < count; ++i)
+		{
+			maxMilliseconds = std::max(maxMilliseconds, telemetry.GetFrame(i).GetTotal());
+		}
+		nk_layout_row_dynamic(context, 150, 1);
+		if (count > 0 && nk_chart_begin_colored(context, NK_CHART_LINES, Phases[0].color, Phases[0].color, count, 0.0f, maxMilliseconds))
+		{
+			for (size_t slot = 1; slot < std::size(Phases); ++slot)
+			{
+				nk_chart_add_slot_colored(context, NK_CHART_LINES, Phases[slot].color, Phases[slot].color, count, 0.0f, maxMilliseconds);
+			}
+			for (int i = 0; i < count; ++i)
+			{
+				const FrameTiming& timing = telemetry.GetFrame(i);
+				for (size_t slot = 0; slot < std::size(Phases); ++slot)
+				{
+					nk_chart_push_slot(context, FrameTelemetry::GetValue(timing, Phases[slot].phase), static_cast<int>(slot));
+				}
+			}
+			nk_chart_end(context);
+		}
+	}
+	nk_end(context);
+	nk_glfw3_render(NK_ANTI_ALIASING_ON);
+}
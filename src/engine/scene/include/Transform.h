@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../../core/include/Math.h"
+#include "../../ecs/include/Component.h"
+#include "../../ecs/include/Entity.h"
+
+// Position, rotation and scale relative to the parent, or to the world for roots.
+struct Transform : public Component
+{
+	static constexpr bool Persistent = true;
+
+	Vec3 position;
+	Quat rotation;
+	Vec3 scale{ 1.0f, 1.0f, 1.0f };
+
+	Mat4 GetLocalMatrix() const { return Mat4::FromTRS(position, rotation, scale); }
+};
+
+// Makes the owning entity's Transform relative to entity's.
+struct Parent : public Component
+{
+	static constexpr bool Persistent = true;
+
+	explicit Parent(Entity entity) : entity(entity) {}
+
+	Entity entity;
+};
+
+// Local-to-world matrix, written by TransformSystem. previous holds the matrix of the
+// step before, so rendering can blend the two by GameLoop's alpha.
+struct WorldTransform : public Component
+{
+	static constexpr bool Persistent = true;
+
+	Mat4 matrix;
+	Mat4 previous;
+
+	Mat4 GetInterpolated(float alpha) const { return Lerp(previous, matrix, alpha); }
+};
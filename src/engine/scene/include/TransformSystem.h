@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../../ecs/include/System.h"
+#include "Transform.h"
+
+class Archetype;
+
+// Computes WorldTransform for every entity with a Transform. The hierarchy is flattened
+// into arrays ordered root by root, each tree breadth-first, so parents always precede
+// their children and world matrices come out of one linear sweep that reads parents
+// from the same array. Trees are independent and are swept in parallel.
+//
+// Rebuilding the order caches each node's component pointers and the chunks each tree
+// spans, so a run does no entity lookups: a tree whose Transform chunks are unchanged
+// since the previous run is skipped after a few version reads, and inside a changed
+// tree only nodes whose own chunk or an ancestor changed are recomputed. The order is
+// rebuilt when a Parent changes or rows move in an archetype holding Transform.
+// Entities with a Transform but no WorldTransform get one added through the command
+// buffer. A Parent pointing at an entity without a Transform is ignored, and entities
+// in a parent cycle are left out. WorldTransform::previous is kept one step behind
+// matrix: nodes written in a run get their previous matrix caught up on the next one,
+// so a node that stops moving stops blending.
+class TransformSystem : public System
+{
+public:
+	TransformSystem()
+	{
+		Reads<Transform, Parent>();
+		Writes<WorldTransform>();
+	}
+
+	const char* GetName() const override { return "TransformSystem"; }
+
+	void Update(float) override;
+
+private:
+	struct Node
+	{
+		Entity entity;
+		// Index of the parent node, or -1 for roots.
+		int32_t parent;
+	};
+
+	// Change versions of one chunk a tree has rows in.
+	struct TreeChunk
+	{
+		const uint32_t* transformVersion;
+		// Null when the chunk's archetype has no WorldTransform.
+		uint32_t* worldVersion;
+	};
+
+	struct LayoutStamp
+	{
+		const Archetype* archetype;
+		uint64_t version;
+	};
+
+	// Component pointers of one Transform row, gathered by Rebuild.
+	struct Row
+	{
+		Entity entity;
+		const Transform* local;
+		const uint32_t* transformVersion;
+		const Parent* parent;
+		WorldTransform* world;
+		uint32_t* worldVersion;
+	};
+
+	bool LayoutChanged() const;
+	void Rebuild();
+
+	EcsVector<Node> nodes;
+	// nodes[treeStarts[i]] up to nodes[treeStarts[i + 1]] is one tree.
+	EcsVector<uint32_t> treeStarts;
+	// treeChunks[treeChunkStarts[i]] up to treeChunks[treeChunkStarts[i + 1]] are the
+	// distinct chunks of tree i.
+	EcsVector<uint32_t> treeChunkStarts;
+	EcsVector<TreeChunk> treeChunks;
+	EcsVector<uint8_t> treeDirty;
+	EcsVector<const Transform*> locals;
+	EcsVector<const uint32_t*> localVersions;
+	EcsVector<WorldTransform*> worldComponents;
+	EcsVector<uint32_t*> worldVersions;
+	EcsVector<Mat4> worlds;
+	EcsVector<uint8_t> dirty;
+	EcsVector<uint32_t> nodeOfEntity;
+	// Layout versions of the Transform archetypes the cached pointers were taken from.
+	EcsVector<LayoutStamp> layouts;
+	// Entities whose WorldTransform was written by the last run.
+	EcsVector<Entity> moved;
+	// Rebuild scratch, kept so rebuilding reuses its capacity.
+	EcsVector<Row> rows;
+	EcsVector<uint32_t> parentOf;
+	EcsVector<uint32_t> childStart;
+	EcsVector<uint32_t> children;
+	EcsVector<uint32_t> fill;
+	EcsVector<uint32_t> source;
+	bool needsRebuild = true;
+};
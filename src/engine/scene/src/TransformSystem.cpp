@@ -0,0 +1,272 @@
+#include "../include/TransformSystem.h"
+#include "../../ecs/include/ECSManager.h"
+#include <algorithm>
+
+namespace
+{
+	constexpr uint32_t NoNode = UINT32_MAX;
+}
+
+void TransformSystem::Update(float)
+{
+	const uint32_t since = GetLastRunVersion();
+	const uint32_t version = ecsManager->GetChangeVersion();
+	const bool rebuild = needsRebuild || LayoutChanged()
+		|| ecsManager->View<const Parent>().ChangedSince<Parent>(since).Count() > 0;
+	if (rebuild)
+	{
+		Rebuild();
+		needsRebuild = false;
+	}
+
+	for (Entity entity : moved)
+	{
+		const Entity::IdType id = entity.GetId();
+		if (id >= nodeOfEntity.size() || nodeOfEntity[id] == NoNode)
+		{
+			continue;
+		}
+		const uint32_t node = nodeOfEntity[id];
+		if (nodes[node].entity == entity && worldComponents[node])
+		{
+			worldComponents[node]->previous = worldComponents[node]->matrix;
+			*worldVersions[node] = version;
+		}
+	}
+	moved.clear();
+
+	// A static scene costs a few chunk-version checks per frame.
+	if (!rebuild && ecsManager->View<const Transform>().ChangedSince<Transform>(since).Count() == 0)
+	{
+		return;
+	}
+
+	const size_t treeCount = treeStarts.size() - 1;
+	treeDirty.resize(treeCount);
+	ecsManager->GetJobSystem().ParallelFor(treeCount, [this, since, rebuild](size_t begin, size_t end)
+	{
+		for (size_t tree = begin; tree < end; ++tree)
+		{
+			bool changed = rebuild;
+			for (uint32_t c = treeChunkStarts[tree]; !changed && c < treeChunkStarts[tree + 1]; ++c)
+			{
+				changed = *treeChunks[c].transformVersion > since;
+			}
+			treeDirty[tree] = changed;
+			if (!changed)
+			{
+				continue;
+			}
+			for (uint32_t i = treeStarts[tree]; i < treeStarts[tree + 1]; ++i)
+			{
+				const int32_t parent = nodes[i].parent;
+				dirty[i] = rebuild || *localVersions[i] > since || (parent >= 0 && dirty[parent]);
+				if (!dirty[i])
+				{
+					continue;
+				}
+				worlds[i] = parent < 0 ? locals[i]->GetLocalMatrix() : worlds[parent] * locals[i]->GetLocalMatrix();
+				if (worldComponents[i])
+				{
+					worldComponents[i]->previous = worldComponents[i]->matrix;
+					worldComponents[i]->matrix = worlds[i];
+				}
+			}
+		}
+	});
+
+	EntityCommandBuffer& commands = ecsManager->GetCommandBuffer();
+	for (size_t tree = 0; tree < treeCount; ++tree)
+	{
+		if (!treeDirty[tree])
+		{
+			continue;
+		}
+		for (uint32_t c = treeChunkStarts[tree]; c < treeChunkStarts[tree + 1]; ++c)
+		{
+			if (treeChunks[c].worldVersion)
+			{
+				*treeChunks[c].worldVersion = version;
+			}
+		}
+		for (uint32_t i = treeStarts[tree]; i < treeStarts[tree + 1]; ++i)
+		{
+			if (!dirty[i])
+			{
+				continue;
+			}
+			if (worldComponents[i])
+			{
+				moved.push_back(nodes[i].entity);
+			}
+			else
+			{
+				commands.AddComponent<WorldTransform>(nodes[i].entity, WorldTransform{ {}, worlds[i], worlds[i] });
+			}
+		}
+	}
+}
+
+bool TransformSystem::LayoutChanged() const
+{
+	const EcsVector<Archetype*>& archetypes = ecsManager->View<const Transform>().GetArchetypes();
+	if (archetypes.size() != layouts.size())
+	{
+		return true;
+	}
+	for (size_t i = 0; i < layouts.size(); ++i)
+	{
+		if (layouts[i].archetype->GetLayoutVersion() != layouts[i].version)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void TransformSystem::Rebuild()
+{
+	const ComponentTypeId transformType = ComponentType<Transform>::Get();
+	const ComponentTypeId parentType = ComponentType<Parent>::Get();
+	const ComponentTypeId worldType = ComponentType<WorldTransform>::Get();
+
+	// Gather every Transform row straight from the chunks, with the pointers the sweep
+	// will need, and stamp each archetype so stale pointers are noticed.
+	rows.clear();
+	layouts.clear();
+	for (Archetype* archetype : ecsManager->View<const Transform>().GetArchetypes())
+	{
+		layouts.push_back({ archetype, archetype->GetLayoutVersion() });
+		const int transformColumn = archetype->FindColumn(transformType);
+		const int parentColumn = archetype->FindColumn(parentType);
+		const int worldColumn = archetype->FindColumn(worldType);
+		for (size_t c = 0; c < archetype->GetChunkCount(); ++c)
+		{
+			const Archetype::Chunk& chunk = archetype->GetChunk(c);
+			const Entity* chunkEntities = archetype->GetEntities(chunk);
+			uint32_t* versions = archetype->GetVersions(chunk);
+			const Transform* chunkLocals = archetype->GetColumn<const Transform>(chunk, transformColumn);
+			const Parent* chunkParents = parentColumn < 0 ? nullptr : archetype->GetColumn<const Parent>(chunk, parentColumn);
+			WorldTransform* chunkWorlds = worldColumn < 0 ? nullptr : archetype->GetColumn<WorldTransform>(chunk, worldColumn);
+			for (uint32_t row = 0; row < chunk.count; ++row)
+			{
+				rows.push_back({
+					chunkEntities[row],
+					chunkLocals + row,
+					versions + transformColumn,
+					chunkParents ? chunkParents + row : nullptr,
+					chunkWorlds ? chunkWorlds + row : nullptr,
+					chunkWorlds ? versions + worldColumn : nullptr });
+			}
+		}
+	}
+
+	// Map entity slots to positions in rows, then link each row to its parent.
+	nodeOfEntity.clear();
+	for (size_t i = 0; i < rows.size(); ++i)
+	{
+		const Entity::IdType id = rows[i].entity.GetId();
+		if (id >= nodeOfEntity.size())
+		{
+			nodeOfEntity.resize(id + 1, NoNode);
+		}
+		nodeOfEntity[id] = static_cast<uint32_t>(i);
+	}
+	parentOf.assign(rows.size(), NoNode);
+	childStart.assign(rows.size() + 1, 0);
+	for (size_t i = 0; i < rows.size(); ++i)
+	{
+		if (!rows[i].parent)
+		{
+			continue;
+		}
+		const Entity parent = rows[i].parent->entity;
+		const Entity::IdType id = parent.GetId();
+		if (id < nodeOfEntity.size() && nodeOfEntity[id] != NoNode && rows[nodeOfEntity[id]].entity == parent)
+		{
+			parentOf[i] = nodeOfEntity[id];
+			++childStart[parentOf[i] + 1];
+		}
+	}
+
+	// Children of row i are children[childStart[i]] up to children[childStart[i + 1]].
+	for (size_t i = 0; i < rows.size(); ++i)
+	{
+		childStart[i + 1] += childStart[i];
+	}
+	children.resize(childStart.back());
+	fill.assign(childStart.begin(), childStart.end() - 1);
+	for (size_t i = 0; i < rows.size(); ++i)
+	{
+		if (parentOf[i] != NoNode)
+		{
+			children[fill[parentOf[i]]++] = static_cast<uint32_t>(i);
+		}
+	}
+
+	// Breadth-first from each root; the node list doubles as the queue.
+	nodes.clear();
+	treeStarts.clear();
+	source.clear();
+	for (size_t root = 0; root < rows.size(); ++root)
+	{
+		if (parentOf[root] != NoNode)
+		{
+			continue;
+		}
+		treeStarts.push_back(static_cast<uint32_t>(nodes.size()));
+		nodes.push_back({ rows[root].entity, -1 });
+		source.push_back(static_cast<uint32_t>(root));
+		for (size_t head = nodes.size() - 1; head < nodes.size(); ++head)
+		{
+			const uint32_t row = source[head];
+			for (uint32_t c = childStart[row]; c < childStart[row + 1]; ++c)
+			{
+				nodes.push_back({ rows[children[c]].entity, static_cast<int32_t>(head) });
+				source.push_back(children[c]);
+			}
+		}
+	}
+	treeStarts.push_back(static_cast<uint32_t>(nodes.size()));
+
+	// Lay the cached pointers out in node order and collect each tree's distinct chunks.
+	locals.resize(nodes.size());
+	localVersions.resize(nodes.size());
+	worldComponents.resize(nodes.size());
+	worldVersions.resize(nodes.size());
+	treeChunkStarts.clear();
+	treeChunks.clear();
+	for (size_t tree = 0; tree + 1 < treeStarts.size(); ++tree)
+	{
+		const size_t first = treeChunks.size();
+		treeChunkStarts.push_back(static_cast<uint32_t>(first));
+		for (uint32_t i = treeStarts[tree]; i < treeStarts[tree + 1]; ++i)
+		{
+			const Row& row = rows[source[i]];
+			locals[i] = row.local;
+			localVersions[i] = row.transformVersion;
+			worldComponents[i] = row.world;
+			worldVersions[i] = row.worldVersion;
+			treeChunks.push_back({ row.transformVersion, row.worldVersion });
+		}
+		auto begin = treeChunks.begin() + first;
+		std::sort(begin, treeChunks.end(), [](const TreeChunk& a, const TreeChunk& b)
+		{
+			return a.transformVersion < b.transformVersion;
+		});
+		treeChunks.erase(std::unique(begin, treeChunks.end(), [](const TreeChunk& a, const TreeChunk& b)
+		{
+			return a.transformVersion == b.transformVersion;
+		}), treeChunks.end());
+	}
+	treeChunkStarts.push_back(static_cast<uint32_t>(treeChunks.size()));
+
+	// Re-point the slot map at final node positions; cycle members stay unmapped.
+	std::fill(nodeOfEntity.begin(), nodeOfEntity.end(), NoNode);
+	for (size_t i = 0; i < nodes.size(); ++i)
+	{
+		nodeOfEntity[nodes[i].entity.GetId()] = static_cast<uint32_t>(i);
+	}
+	worlds.assign(nodes.size(), Mat4());
+	dirty.resize(nodes.size());
+}
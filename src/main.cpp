@@ -1,16 +1,74 @@
+#include "engine/core/include/FrameTelemetry.h"
+#include "engine/core/include/GameLoop.h"
+#include "engine/core/include/MemoryTracker.h"
+#include "engine/core/include/Profiler.h"
 #include "engine/ecs/include/ECSManager.h"
 #include "engine/renderer/include/OpenGLRenderer.h"
 #include "engine/renderer/include/MeshRenderer.h"
 #include "engine/renderer/include/RenderSystem.h"
+#include "engine/renderer/include/RenderExtractSystem.h"
+#include "engine/renderer/include/RenderThread.h"
+#include "engine/renderer/include/TelemetryOverlay.h"
+#include "engine/scene/include/TransformSystem.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
+	// The render thread owns the context in threaded mode.
+	if (auto* renderThread = static_cast<RenderThread*>(glfwGetWindowUserPointer(window)))
+	{
+		renderThread->Resize(width, height);
+		return;
+	}
 	glViewport(0, 0, width, height);
 }
 
-int main()
+int main(int argc, char** argv)
 {
+	// With --render-thread, frame N is drawn on its own thread while frame N + 1 simulates.
+	// --no-vsync renders as fast as possible; the simulation rate is fixed either way.
+	// --system-timings <path> records per-system timings and writes them (CSV, or JSON for
+	// a .json path) on exit. --profile <frames> <path> captures that many frames as a
+	// Chrome trace. --overlay shows frame time statistics over the scene and
+	// --telemetry <path> writes them as JSON on exit. --memory-report samples allocation
+	// call stacks and prints per-subsystem memory use on exit.
+	bool threadedRendering = false;
+	bool vsync = true;
+	bool showOverlay = false;
+	bool memoryReport = false;
+	const char* systemTimingsPath = nullptr;
+	const char* telemetryPath = nullptr;
+	for (int i = 1; i < argc; ++i)
+	{
+		threadedRendering |= std::strcmp(argv[i], "--render-thread") == 0;
+		vsync &= std::strcmp(argv[i], "--no-vsync") != 0;
+		showOverlay |= std::strcmp(argv[i], "--overlay") == 0;
+		memoryReport |= std::strcmp(argv[i], "--memory-report") == 0;
+		if (std::strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc)
+		{
+			telemetryPath = argv[++i];
+		}
+		if (std::strcmp(argv[i], "--system-timings") == 0 && i + 1 < argc)
+		{
+			systemTimingsPath = argv[++i];
+		}
+		if (std::strcmp(argv[i], "--profile") == 0 && i + 2 < argc)
+		{
+			Profiler::StartCapture(static_cast<uint32_t>(std::strtoul(argv[i + 1], nullptr, 10)), argv[i + 2]);
+			i += 2;
+		}
+	}
+
+	Profiler::SetThreadName("Main");
+	MemoryTracker::SetBudget(MemoryTag::ECS, size_t(256) << 20);
+	MemoryTracker::SetBudget(MemoryTag::Renderer, size_t(64) << 20);
+	MemoryTracker::SetCallstackSampling(memoryReport ? 1024 : 0);
+	SystemTimings::SetAllocationCounter(&MemoryTracker::GetThreadAllocationCount);
+
 	if (!glfwInit())
 	{
 		std::cerr << "Failed to initialise GLFW" << std::endl;
@@ -29,27 +87,117 @@ int main()
 	}
 
 	glfwMakeContextCurrent(window);
+	glfwSwapInterval(vsync ? 1 : 0);
 	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
 	OpenGLRenderer renderer;
 	renderer.InitializeImpl();
 
 	ECSManager ecsManager;
+	ecsManager.GetSystemTimings().SetEnabled(systemTimingsPath != nullptr);
+
+	ecsManager.AddSystem(std::make_shared<TransformSystem>());
 
-	auto renderSystem = std::make_shared<RenderSystem>();
-	ecsManager.AddSystem(renderSystem);
+	// Rendering runs once per frame, outside the fixed simulation steps.
+	RenderFrames renderFrames;
+	RenderExtractSystem extractSystem(renderFrames);
+	extractSystem.SetECSManager(&ecsManager);
+	RenderSystem renderSystem;
+	renderSystem.SetECSManager(&ecsManager);
 
 	Entity entity = ecsManager.CreateEntity();
-	entity.AddComponent(std::make_shared<MeshRenderer>(renderer));
+	ecsManager.AddComponent<MeshRenderer>(entity, renderer);
+	ecsManager.AddComponent<Transform>(entity);
+
+	std::unique_ptr<RenderThread> renderThread;
+	if (threadedRendering)
+	{
+		glfwMakeContextCurrent(nullptr);
+		renderThread = std::make_unique<RenderThread>(window, renderFrames);
+		glfwSetWindowUserPointer(window, renderThread.get());
+		renderThread->Start();
+	}
+
+	// The overlay draws with the context, so it needs rendering on this thread.
+	FrameTelemetry telemetry;
+	std::unique_ptr<TelemetryOverlay> overlay;
+	if (showOverlay && renderThread)
+	{
+		std::cerr << "The telemetry overlay is not available with --render-thread" << std::endl;
+	}
+	else if (showOverlay)
+	{
+		overlay = std::make_unique<TelemetryOverlay>(window);
+	}
+
+	using Clock = std::chrono::steady_clock;
+	auto milliseconds = [](Clock::duration duration) { return std::chrono::duration<float, std::milli>(duration).count(); };
 
+	GameLoop gameLoop;
 	while (!glfwWindowShouldClose(window))
 	{
-		ecsManager.UpdateSystems(0.016f);
+		{
+			PROFILE_ZONE("Frame");
+			const Clock::time_point start = Clock::now();
+			{
+				PROFILE_ZONE("Simulate");
+				gameLoop.Advance([&](float stepSeconds)
+				{
+					ecsManager.UpdateSystems(stepSeconds);
+				});
+			}
+			const Clock::time_point simulated = Clock::now();
+
+			if (renderThread)
+			{
+				PROFILE_ZONE("Extract");
+				extractSystem.Extract(gameLoop.GetAlpha());
+			}
+			else
+			{
+				renderSystem.Render(gameLoop.GetAlpha());
+				if (overlay)
+				{
+					overlay->Draw(telemetry);
+				}
+			}
+			const Clock::time_point rendered = Clock::now();
+
+			if (!renderThread)
+			{
+				PROFILE_ZONE("SwapBuffers");
+				glfwSwapBuffers(window);
+			}
+			telemetry.Record({ milliseconds(simulated - start), milliseconds(rendered - simulated), milliseconds(Clock::now() - rendered) });
+
+			PROFILE_ZONE("PollEvents");
+			glfwPollEvents();
+		}
+		Profiler::EndFrame();
+	}
+
+	if (renderThread)
+	{
+		renderThread->Stop();
+		glfwSetWindowUserPointer(window, nullptr);
+		renderThread.reset();
+		glfwMakeContextCurrent(window);
+	}
 
-		glfwSwapBuffers(window);
-		glfwPollEvents();
+	if (systemTimingsPath)
+	{
+		ecsManager.GetSystemTimings().Save(systemTimingsPath);
+	}
+	if (telemetryPath)
+	{
+		telemetry.Save(telemetryPath);
+	}
+	if (memoryReport)
+	{
+		MemoryTracker::Dump(std::cout);
 	}
 
+	overlay.reset();
 	renderer.ShutdownImpl();
 	glfwDestroyWindow(window);
 	glfwTerminate();
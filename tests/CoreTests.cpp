@@ -0,0 +1,174 @@
+// Frame pacing: GameLoop step accounting and FrameTelemetry statistics. Jobs: every job
+// running exactly once while owners push and pop and idle threads steal.
+
+#include "../src/engine/core/include/FrameTelemetry.h"
+#include "../src/engine/core/include/GameLoop.h"
+#include "../src/engine/core/include/JobSystem.h"
+#include "Test.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+	using Milliseconds = std::chrono::milliseconds;
+
+	bool Near(double a, double b)
+	{
+		return std::fabs(a - b) < 1e-6;
+	}
+}
+
+TEST(GameLoopStepAccounting)
+{
+	GameLoop loop(0.01, 4);
+	uint32_t calls = 0;
+	auto step = [&](float seconds)
+	{
+		CHECK(seconds == loop.GetStepSeconds());
+		++calls;
+	};
+
+	CHECK(loop.AdvanceBy(Milliseconds(5), step) == 0);
+	CHECK(Near(loop.GetAlpha(), 0.5));
+	// The leftover carries into the next frame.
+	CHECK(loop.AdvanceBy(Milliseconds(20), step) == 2);
+	CHECK(Near(loop.GetAlpha(), 0.5));
+	CHECK(loop.AdvanceBy(Milliseconds(5), step) == 1);
+	CHECK(Near(loop.GetAlpha(), 0.0));
+	CHECK(Near(loop.GetFrameSeconds(), 0.005));
+	CHECK(loop.GetStepCount() == 3);
+	CHECK(calls == 3);
+
+	// A stall runs at most maxStepsPerFrame steps and drops the rest of the owed time.
+	CHECK(loop.AdvanceBy(Milliseconds(1003), step) == 4);
+	CHECK(Near(loop.GetDroppedSeconds(), 0.96));
+	CHECK(Near(loop.GetAlpha(), 0.3));
+	CHECK(loop.GetStepCount() == 7);
+
+	// Negative elapsed time, e.g. from a replay, owes nothing.
+	CHECK(loop.AdvanceBy(Milliseconds(-50), step) == 0);
+	CHECK(Near(loop.GetAlpha(), 0.3));
+
+	loop.Reset();
+	CHECK(loop.GetAlpha() == 0.0f);
+	CHECK(calls == 7);
+}
+
+TEST(FrameTelemetryPercentiles)
+{
+	const size_t capacity = 500;
+	FrameTelemetry telemetry(capacity, 20.0f);
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> simulate(0.5f, 12.0f);
+	std::uniform_real_distribution<float> render(0.1f, 9.0f);
+	std::vector<FrameTiming> recorded;
+	// Overfill the ring so frames leaving it are taken back out of the histograms.
+	for (size_t i = 0; i < capacity * 3 + 17; ++i)
+	{
+		FrameTiming timing;
+		timing.simulateMilliseconds = simulate(random);
+		timing.renderMilliseconds = render(random);
+		timing.swapMilliseconds = i % 97 == 0 ? 150.0f : 0.2f;
+		telemetry.Record(timing);
+		recorded.push_back(timing);
+	}
+	CHECK(telemetry.GetCount() == capacity);
+	CHECK(telemetry.GetTotalFrameCount() == recorded.size());
+
+	const std::vector<FrameTiming> window(recorded.end() - capacity, recorded.end());
+	for (size_t phase = 0; phase < FrameTelemetry::PhaseCount; ++phase)
+	{
+		const FrameTelemetry::Phase which = static_cast<FrameTelemetry::Phase>(phase);
+		std::vector<float> sorted;
+		double sum = 0.0;
+		for (const FrameTiming& timing : window)
+		{
+			sorted.push_back(FrameTelemetry::GetValue(timing, which));
+			sum += sorted.back();
+		}
+		std::sort(sorted.begin(), sorted.end());
+		CHECK(std::fabs(telemetry.GetAverage(which) - sum / capacity) < 1e-3);
+
+		for (float percentile : { 1.0f, 50.0f, 90.0f, 99.0f, 100.0f })
+		{
+			const size_t rank = std::max<size_t>(static_cast<size_t>(std::ceil(percentile / 100.0f * capacity)), 1);
+			const float reference = std::min(sorted[rank - 1], FrameTelemetry::BucketCount * FrameTelemetry::BucketMilliseconds);
+			// Percentiles report the upper edge of the reference value's bucket.
+			const float reported = telemetry.GetPercentile(which, percentile);
+			CHECK(reported >= reference - 1e-3f);
+			CHECK(reported <= reference + FrameTelemetry::BucketMilliseconds + 1e-3f);
+		}
+	}
+
+	size_t hitches = 0;
+	for (const FrameTiming& timing : window)
+	{
+		hitches += timing.GetTotal() > telemetry.GetHitchMilliseconds();
+	}
+	CHECK(telemetry.GetHitchCount() == hitches);
+}
+
+TEST(JobSystemRunsEveryJobOnce)
+{
+	JobSystem jobs(3);
+	static constexpr size_t Parents = JobSystem::MaxJobsPerThread * 3;
+	static constexpr size_t ChildrenPerParent = 4;
+	std::unique_ptr<std::atomic<uint32_t>[]> parentRuns(new std::atomic<uint32_t>[Parents]);
+	std::unique_ptr<std::atomic<uint32_t>[]> childRuns(new std::atomic<uint32_t>[Parents * ChildrenPerParent]);
+	for (size_t i = 0; i < Parents; ++i)
+	{
+		parentRuns[i].store(0);
+	}
+	for (size_t i = 0; i < Parents * ChildrenPerParent; ++i)
+	{
+		childRuns[i].store(0);
+	}
+
+	// More jobs than the owner's deque holds, each pushing children onto the deque of
+	// whichever thread runs it; the owner pops while waiting and workers steal.
+	JobCounter counter;
+	for (size_t i = 0; i < Parents; ++i)
+	{
+		jobs.Run([&, i]
+		{
+			parentRuns[i].fetch_add(1);
+			for (size_t c = 0; c < ChildrenPerParent; ++c)
+			{
+				jobs.Run([&childRuns, i, c] { childRuns[i * ChildrenPerParent + c].fetch_add(1); }, &counter);
+			}
+		}, &counter);
+	}
+	jobs.Wait(counter);
+
+	bool once = true;
+	for (size_t i = 0; i < Parents; ++i)
+	{
+		once = once && parentRuns[i].load() == 1;
+	}
+	for (size_t i = 0; i < Parents * ChildrenPerParent; ++i)
+	{
+		once = once && childRuns[i].load() == 1;
+	}
+	CHECK(once);
+	CHECK(jobs.GetStats().executed == Parents * (1 + ChildrenPerParent));
+
+	// Batches of one or two jobs keep the owner's pop racing thieves for the last job.
+	jobs.ResetStats();
+	std::atomic<uint32_t> runs{ 0 };
+	for (int batch = 0; batch < 5000; ++batch)
+	{
+		JobCounter small;
+		for (int j = 0; j <= batch % 2; ++j)
+		{
+			jobs.Run([&runs] { runs.fetch_add(1); }, &small);
+		}
+		jobs.Wait(small);
+	}
+	CHECK(runs.load() == 7500);
+	CHECK(jobs.GetStats().executed == 7500);
+}
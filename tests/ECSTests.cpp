@@ -0,0 +1,320 @@
+// Entity and archetype bookkeeping: component data surviving archetype moves, stale
+// handles after slot reuse, command buffer playback order, component types
+// registering from several threads at once and prefab instantiation.
+
+#include "../src/engine/ecs/include/ECSManager.h"
+#include "../src/engine/ecs/include/Prefab.h"
+#include "Test.h"
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	struct Position : Component
+	{
+		float x = 0.0f, y = 0.0f, z = 0.0f;
+	};
+
+	struct Velocity : Component
+	{
+		float x = 0.0f, y = 0.0f, z = 0.0f;
+	};
+
+	struct Health : Component
+	{
+		int32_t value = 100;
+	};
+
+	struct Marked : Component
+	{
+		static constexpr ComponentStorage Storage = ComponentStorage::Tag;
+	};
+
+	struct Cooldown : Component
+	{
+		static constexpr ComponentStorage Storage = ComponentStorage::SparseSet;
+		int32_t frames = 0;
+	};
+
+	// Not trivially copyable, so instances are copy-constructed rather than memcpy'd.
+	struct Name : Component
+	{
+		std::string value;
+	};
+
+	// Requires Position and Health, to check instances join system entity sets.
+	class HealthSystem : public System
+	{
+	public:
+		HealthSystem() { Requires<Position, Health>(); }
+
+		void Update(float) override {}
+	};
+
+	// Distinct types whose ids are first requested from worker threads.
+	template <int N>
+	struct Probe : Component
+	{
+		char bytes[N + 1] = {};
+	};
+
+	template <int... Ns>
+	void RegisterProbes(ComponentTypeId* ids, std::integer_sequence<int, Ns...>)
+	{
+		((ids[Ns] = ComponentType<Probe<Ns>>::Get()), ...);
+	}
+
+	// Enough entities to span several chunks, so moves and swap-removes cross chunk edges.
+	constexpr int EntityCount = 5000;
+}
+
+TEST(ArchetypeAddRemoveRoundTrip)
+{
+	ECSManager world;
+	std::vector<Entity> entities;
+	for (int i = 0; i < EntityCount; ++i)
+	{
+		Entity entity = world.CreateEntity();
+		world.AddComponent<Position>(entity).x = static_cast<float>(i);
+		entities.push_back(entity);
+	}
+
+	for (int i = 0; i < EntityCount; i += 2)
+	{
+		world.AddComponent<Velocity>(entities[i]).y = static_cast<float>(-i);
+		world.AddComponent<Marked>(entities[i]);
+	}
+	for (int i = 0; i < EntityCount; i += 4)
+	{
+		world.RemoveComponent<Position>(entities[i]);
+	}
+	for (int i = 1; i < EntityCount; i += 3)
+	{
+		world.DestroyEntity(entities[i]);
+	}
+
+	for (int i = 0; i < EntityCount; ++i)
+	{
+		Entity entity = entities[i];
+		if (i % 3 == 1)
+		{
+			CHECK(!world.IsAlive(entity));
+			continue;
+		}
+		CHECK(world.IsAlive(entity));
+		const Position* position = world.ReadComponent<Position>(entity);
+		CHECK((position != nullptr) == (i % 4 != 0));
+		if (position)
+		{
+			CHECK(position->x == static_cast<float>(i));
+		}
+		const Velocity* velocity = world.ReadComponent<Velocity>(entity);
+		CHECK((velocity != nullptr) == (i % 2 == 0));
+		if (velocity)
+		{
+			CHECK(velocity->y == static_cast<float>(-i));
+		}
+		CHECK(world.HasComponent<Marked>(entity) == (i % 2 == 0));
+	}
+
+	// Moving back to the original archetype keeps the other component's value.
+	for (int i = 0; i < EntityCount; i += 4)
+	{
+		if (i % 3 == 1)
+		{
+			continue;
+		}
+		world.AddComponent<Position>(entities[i]).x = static_cast<float>(i);
+		world.RemoveComponent<Velocity>(entities[i]);
+		world.RemoveComponent<Marked>(entities[i]);
+	}
+	size_t visited = 0;
+	world.Each<const Position>([&](Entity entity, const Position& position)
+	{
+		CHECK(position.x == static_cast<float>(entity.GetId()));
+		++visited;
+	});
+	size_t alive = 0;
+	for (int i = 0; i < EntityCount; ++i)
+	{
+		alive += i % 3 != 1;
+	}
+	CHECK(visited == alive);
+	CHECK(world.GetEntityCount() == alive);
+
+	// A tagged entity leaving from the last row must not pass its tag to the row's next
+	// owner. The first entity keeps the chunk alive.
+	world.AddComponent<Health>(world.CreateEntity());
+	Entity leaving = world.CreateEntity();
+	world.AddComponent<Health>(leaving);
+	world.AddComponent<Marked>(leaving);
+	world.AddComponent<Velocity>(leaving);
+	Entity next = world.CreateEntity();
+	world.AddComponent<Health>(next);
+	CHECK(world.HasComponent<Marked>(leaving));
+	CHECK(!world.HasComponent<Marked>(next));
+}
+
+TEST(ReusedSlotRejectsStaleHandle)
+{
+	ECSManager world;
+	Entity stale = world.CreateEntity();
+	world.AddComponent<Health>(stale).value = 1;
+	world.DestroyEntity(stale);
+
+	Entity reused = world.CreateEntity();
+	world.AddComponent<Health>(reused).value = 2;
+	CHECK(reused.GetId() == stale.GetId());
+	CHECK(reused.GetGeneration() != stale.GetGeneration());
+
+	CHECK(!world.IsAlive(stale));
+	CHECK(world.IsAlive(reused));
+	CHECK(world.GetComponent<Health>(stale) == nullptr);
+	CHECK(!world.HasComponent<Health>(stale));
+
+	// Operations through the stale handle must not reach the slot's new owner.
+	world.DestroyEntity(stale);
+	CHECK(world.IsAlive(reused));
+	CHECK(world.ReadComponent<Health>(reused) && world.ReadComponent<Health>(reused)->value == 2);
+
+	world.GetCommandBuffer().DestroyEntity(stale);
+	world.GetCommandBuffer().RemoveComponent<Health>(stale);
+	world.PlaybackCommandBuffers();
+	CHECK(world.IsAlive(reused));
+	CHECK(world.HasComponent<Health>(reused));
+}
+
+TEST(CommandBufferPlaybackOrder)
+{
+	ECSManager world;
+	Entity replaced = world.CreateEntity();
+	Entity addedThenRemoved = world.CreateEntity();
+	Entity removedThenAdded = world.CreateEntity();
+	Entity destroyed = world.CreateEntity();
+	world.AddComponent<Position>(removedThenAdded).x = 1.0f;
+
+	EntityCommandBuffer& commands = world.GetCommandBuffer();
+	// Interleaved across entities; only the order per entity matters.
+	commands.AddComponent<Health>(replaced, Health{ {}, 10 });
+	commands.AddComponent<Health>(addedThenRemoved, Health{ {}, 10 });
+	commands.RemoveComponent<Position>(removedThenAdded);
+	commands.AddComponent<Health>(replaced, Health{ {}, 20 });
+	commands.RemoveComponent<Health>(addedThenRemoved);
+	commands.AddComponent<Position>(removedThenAdded, Position{ {}, 2.0f, 0.0f, 0.0f });
+	commands.AddComponent<Health>(destroyed, Health{ {}, 10 });
+	commands.DestroyEntity(destroyed);
+	Entity created = commands.CreateEntity();
+	commands.AddComponent<Velocity>(created, Velocity{ {}, 3.0f, 0.0f, 0.0f });
+	commands.AddComponent<Marked>(created);
+
+	// Nothing is applied until playback.
+	CHECK(!world.HasComponent<Health>(replaced));
+	CHECK(world.IsAlive(destroyed));
+	CHECK(world.GetEntityCount() == 4);
+
+	world.PlaybackCommandBuffers();
+	CHECK(world.ReadComponent<Health>(replaced) && world.ReadComponent<Health>(replaced)->value == 20);
+	CHECK(!world.HasComponent<Health>(addedThenRemoved));
+	CHECK(world.ReadComponent<Position>(removedThenAdded) && world.ReadComponent<Position>(removedThenAdded)->x == 2.0f);
+	CHECK(!world.IsAlive(destroyed));
+	CHECK(world.GetEntityCount() == 4);
+
+	size_t createdCount = 0;
+	world.Each<const Velocity>([&](Entity entity, const Velocity& velocity)
+	{
+		CHECK(velocity.x == 3.0f);
+		CHECK(world.HasComponent<Marked>(entity));
+		++createdCount;
+	});
+	CHECK(createdCount == 1);
+	CHECK(commands.IsEmpty());
+}
+
+TEST(ComponentTypesRegisterConcurrently)
+{
+	const ComponentInfo& existing = ComponentRegistry::GetInfo(ComponentType<Position>::Get());
+	const size_t before = ComponentRegistry::GetCount();
+
+	// Each thread registers its own probes, so registrations interleave.
+	ComponentTypeId ids[16];
+	std::thread threads[4] = {
+		std::thread([&] { RegisterProbes(ids, std::integer_sequence<int, 0, 1, 2, 3>()); }),
+		std::thread([&] { RegisterProbes(ids, std::integer_sequence<int, 4, 5, 6, 7>()); }),
+		std::thread([&] { RegisterProbes(ids, std::integer_sequence<int, 8, 9, 10, 11>()); }),
+		std::thread([&] { RegisterProbes(ids, std::integer_sequence<int, 12, 13, 14, 15>()); }),
+	};
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	CHECK(ComponentRegistry::GetCount() == before + 16);
+	Signature seen;
+	for (int i = 0; i < 16; ++i)
+	{
+		CHECK(ids[i] >= before && ids[i] < before + 16 && !seen.test(ids[i]));
+		seen.set(ids[i]);
+		// Probe<N> is N + 1 bytes.
+		CHECK(ComponentRegistry::GetInfo(ids[i]).size == static_cast<size_t>(i + 1));
+		CHECK(ComponentRegistry::Find(ComponentRegistry::GetInfo(ids[i]).name) == ids[i]);
+	}
+	// Entries registered earlier stay where they were.
+	CHECK(&existing == &ComponentRegistry::GetInfo(ComponentType<Position>::Get()));
+	CHECK(existing.size == sizeof(Position));
+}
+
+TEST(PrefabInstancesCopyEveryComponent)
+{
+	ECSManager world;
+	auto system = std::make_shared<HealthSystem>();
+	world.AddSystem(system);
+	world.UpdateSystems(0.0f);
+
+	// Free slots are reused before fresh ones are appended.
+	Entity freed = world.CreateEntity();
+	Entity kept = world.CreateEntity();
+	world.AddComponent<Position>(kept).x = -1.0f;
+	world.DestroyEntity(freed);
+
+	Prefab prefab;
+	prefab.Set<Position>().x = 1.0f;
+	prefab.Set<Health>().value = 5;
+	prefab.Set<Name>().value = "a name long enough to live on the heap";
+	prefab.Set<Marked>();
+	prefab.Set<Cooldown>().frames = 3;
+	prefab.Set<Health>().value = 7;
+
+	constexpr size_t Count = 5000;
+	std::span<const Entity> spawned = world.Instantiate(prefab, Count);
+	CHECK(spawned.size() == Count);
+	CHECK(spawned[0].GetId() == freed.GetId() && spawned[0] != freed);
+	CHECK(world.GetEntityCount() == Count + 1);
+	const std::vector<Entity> instances(spawned.begin(), spawned.end());
+
+	bool copied = true;
+	for (Entity entity : instances)
+	{
+		const Position* position = world.ReadComponent<Position>(entity);
+		const Health* health = world.ReadComponent<Health>(entity);
+		const Name* name = world.ReadComponent<Name>(entity);
+		const Cooldown* cooldown = world.ReadComponent<Cooldown>(entity);
+		copied = copied && world.IsAlive(entity) && position && position->x == 1.0f && health && health->value == 7
+			&& name && name->value == prefab.Get<Name>()->value && cooldown && cooldown->frames == 3
+			&& world.HasComponent<Marked>(entity) && !world.HasComponent<Velocity>(entity);
+	}
+	CHECK(copied);
+	CHECK(world.ReadComponent<Position>(kept)->x == -1.0f && !world.HasComponent<Health>(kept));
+
+	// Instances are independent copies and ordinary entities afterwards.
+	world.GetComponent<Name>(instances[1])->value = "changed";
+	CHECK(world.ReadComponent<Name>(instances[2])->value == prefab.Get<Name>()->value);
+	world.AddComponent<Velocity>(instances[3]);
+	world.DestroyEntity(instances[4]);
+	CHECK(world.ReadComponent<Health>(instances[3])->value == 7);
+
+	world.UpdateSystems(0.0f);
+	CHECK(system->GetEntities().size() == Count - 1);
+}
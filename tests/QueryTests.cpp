@@ -0,0 +1,216 @@
+// Queries: change filters visiting only chunks written since a version, tag filters
+// selecting rows across chunks and archetypes, and parallel iteration and reduction.
+
+#include "../src/engine/core/include/JobSystem.h"
+#include "../src/engine/ecs/include/ECSManager.h"
+#include "Test.h"
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace QueryTests
+{
+	struct Position : Component
+	{
+		float x = 0.0f, y = 0.0f, z = 0.0f;
+	};
+
+	struct Velocity : Component
+	{
+		float x = 0.0f, y = 0.0f, z = 0.0f;
+	};
+
+	struct Static : Component
+	{
+		static constexpr ComponentStorage Storage = ComponentStorage::Tag;
+	};
+
+	struct Selected : Component
+	{
+		static constexpr ComponentStorage Storage = ComponentStorage::Tag;
+	};
+
+	// Enough entities per archetype to fill several chunks.
+	constexpr int EntityCount = 3000;
+
+	// Counts the positions written since its previous run.
+	class ChangeCounter : public System
+	{
+	public:
+		ChangeCounter() { Reads<Position>(); }
+
+		void Update(float) override
+		{
+			seen = ecsManager->View<const Position>().ChangedSince<Position>(GetLastRunVersion()).Count();
+		}
+
+		size_t seen = 0;
+	};
+}
+
+using namespace QueryTests;
+
+TEST(ChangedSinceVisitsWrittenChunks)
+{
+	ECSManager world;
+	auto counter = std::make_shared<ChangeCounter>();
+	world.AddSystem(counter);
+	std::vector<Entity> still;
+	for (int i = 0; i < EntityCount; ++i)
+	{
+		Entity entity = world.CreateEntity();
+		world.AddComponent<Position>(entity);
+		still.push_back(entity);
+		Entity moving = world.CreateEntity();
+		world.AddComponent<Position>(moving);
+		world.AddComponent<Velocity>(moving);
+	}
+
+	// The first run sees every entity, the next one none.
+	world.UpdateSystems(0.0f);
+	CHECK(counter->seen == 2 * EntityCount);
+	world.UpdateSystems(0.0f);
+	CHECK(counter->seen == 0);
+
+	// Read-only access leaves versions alone.
+	CHECK(world.ReadComponent<Position>(still[0]) != nullptr);
+	world.View<const Position>().Each([](Entity, const Position&) {});
+	world.UpdateSystems(0.0f);
+	CHECK(counter->seen == 0);
+
+	// A single write marks its whole chunk and nothing else.
+	const uint32_t beforeWrite = world.GetChangeVersion();
+	world.GetComponent<Position>(still[0])->x = 1.0f;
+	bool found = false;
+	world.View<const Position>().ChangedSince<Position>(beforeWrite - 1).Each([&](Entity entity, const Position&)
+	{
+		found = found || entity == still[0];
+	});
+	CHECK(found);
+	world.UpdateSystems(0.0f);
+	CHECK(counter->seen > 1 && counter->seen < EntityCount);
+
+	// Mutable iteration marks the non-const components of every chunk it visits.
+	world.UpdateSystems(0.0f);
+	const uint32_t beforeIteration = world.GetChangeVersion() - 1;
+	world.View<const Position, Velocity>().Each([](Entity, const Position&, Velocity& velocity)
+	{
+		velocity.x += 1.0f;
+	});
+	CHECK(world.View<const Velocity>().ChangedSince<Velocity>(beforeIteration).Count() == EntityCount);
+	CHECK(world.View<const Position>().ChangedSince<Position>(beforeIteration).Count() == 0);
+	CHECK(world.View<const Position, const Velocity>().ChangedSince<Position, Velocity>(beforeIteration).Count() == EntityCount);
+	world.UpdateSystems(0.0f);
+	CHECK(counter->seen == 0);
+}
+
+TEST(TagFiltersSelectTaggedRows)
+{
+	ECSManager world;
+	std::vector<Entity> entities;
+	for (int i = 0; i < EntityCount; ++i)
+	{
+		Entity entity = world.CreateEntity();
+		world.AddComponent<Position>(entity).x = static_cast<float>(i);
+		if (i % 3 == 0)
+		{
+			world.AddComponent<Static>(entity);
+		}
+		if (i % 5 == 0)
+		{
+			world.AddComponent<Selected>(entity);
+		}
+		entities.push_back(entity);
+	}
+	// An archetype that has never stored either tag.
+	for (int i = 0; i < 100; ++i)
+	{
+		world.AddComponent<Velocity>(world.CreateEntity());
+	}
+
+	// True if view visits exactly the live entities[i] for which expected(i) holds.
+	auto matches = [&](const ComponentView<const Position>& view, auto expected)
+	{
+		size_t count = 0;
+		bool exact = true;
+		view.Each([&](Entity entity, const Position& position)
+		{
+			const int i = static_cast<int>(position.x);
+			exact = exact && entities[i] == entity && expected(i);
+			++count;
+		});
+		size_t wanted = 0;
+		for (int i = 0; i < EntityCount; ++i)
+		{
+			wanted += world.IsAlive(entities[i]) && expected(i);
+		}
+		return exact && count == wanted && view.Count() == wanted;
+	};
+
+	CHECK(matches(world.View<const Position>().With<Static>(), [](int i) { return i % 3 == 0; }));
+	CHECK(matches(world.View<const Position>().Without<Static>(), [](int i) { return i % 3 != 0; }));
+	CHECK(matches(world.View<const Position>().With<Static, Selected>(), [](int i) { return i % 15 == 0; }));
+	CHECK(matches(world.View<const Position>().With<Static>().Without<Selected>(), [](int i) { return i % 3 == 0 && i % 5 != 0; }));
+	CHECK(world.View<const Velocity>().With<Static>().Count() == 0);
+	CHECK(world.View<const Velocity>().Without<Static>().Count() == 100);
+
+	// Removing tags and swap-removing rows keep the bits with their entities.
+	for (int i = 0; i < EntityCount; i += 6)
+	{
+		world.RemoveComponent<Static>(entities[i]);
+	}
+	for (int i = 1; i < EntityCount; i += 7)
+	{
+		world.DestroyEntity(entities[i]);
+	}
+	CHECK(matches(world.View<const Position>().With<Static>(), [](int i) { return i % 3 == 0 && i % 6 != 0; }));
+	CHECK(matches(world.View<const Position>().Without<Static, Selected>(), [](int i) { return (i % 3 != 0 || i % 6 == 0) && i % 5 != 0; }));
+}
+
+TEST(ParallelReduceIsDeterministic)
+{
+	ECSManager world;
+	constexpr int Count = 20000;
+	for (int i = 0; i < Count; ++i)
+	{
+		Entity entity = world.CreateEntity();
+		// Magnitudes far apart, so the sum depends on the order it is taken in.
+		world.AddComponent<Position>(entity).x = static_cast<float>(i % 2 ? 1e7 / (i + 1) : 1.0 / (i + 1));
+		world.AddComponent<Velocity>(entity);
+	}
+
+	// Every entity is visited once, whichever thread runs its chunk.
+	JobSystem workers(3);
+	world.View<const Position, Velocity>().ParallelForEach(workers, [](Entity, const Position& position, Velocity& velocity)
+	{
+		velocity.x += position.x * 2.0f;
+	});
+	bool once = true;
+	world.Each<const Position, const Velocity>([&](Entity, const Position& position, const Velocity& velocity)
+	{
+		once = once && velocity.x == position.x * 2.0f;
+	});
+	CHECK(once);
+
+	auto sum = [&](JobSystem& jobs)
+	{
+		return world.View<const Position>().ParallelReduce(jobs, 0.0f,
+			[](float& total, Entity, const Position& position) { total += position.x; },
+			[](float& total, const float& partial) { total += partial; });
+	};
+	JobSystem single(0);
+	const float expected = sum(single);
+	double exact = 0.0;
+	world.Each<const Position>([&](Entity, const Position& position) { exact += position.x; });
+	CHECK(std::fabs(expected - exact) <= std::fabs(exact) * 1e-5);
+
+	// Bit-identical whatever the thread count and timing.
+	bool identical = true;
+	for (int run = 0; run < 20; ++run)
+	{
+		const float total = sum(run % 2 ? single : workers);
+		identical = identical && std::memcmp(&total, &expected, sizeof(float)) == 0;
+	}
+	CHECK(identical);
+}
@@ -0,0 +1,53 @@
+// Simulation to render thread hand-off through RenderFrames.
+
+#include "../src/engine/renderer/include/RenderFrame.h"
+#include "Test.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+TEST(RenderFramesDrawEveryFrameInOrder)
+{
+	constexpr uint64_t FrameCount = 200;
+	RenderFrames frames;
+	std::vector<uint64_t> drawn;
+	std::thread render([&]
+	{
+		while (const RenderFrame* frame = frames.Acquire())
+		{
+			drawn.push_back(frame->index);
+			// Slower than the simulation, as when presenting waits on vsync.
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+			frames.Release();
+		}
+	});
+
+	for (uint64_t i = 0; i < FrameCount; ++i)
+	{
+		RenderFrame& frame = frames.BeginExtract();
+		CHECK(frame.index == i);
+		CHECK(frame.items.empty());
+		frame.alpha = 0.5f;
+		frames.EndExtract();
+	}
+	// Returns once the last published frame has been acquired.
+	frames.BeginExtract();
+	frames.Stop();
+	render.join();
+
+	CHECK(drawn.size() == FrameCount);
+	for (size_t i = 0; i < drawn.size(); ++i)
+	{
+		CHECK(drawn[i] == i);
+	}
+}
+
+TEST(RenderFramesStopWakesRenderSide)
+{
+	RenderFrames frames;
+	const RenderFrame* acquired = &frames.BeginExtract();
+	std::thread render([&] { acquired = frames.Acquire(); });
+	frames.Stop();
+	render.join();
+	CHECK(acquired == nullptr);
+}
@@ -0,0 +1,95 @@
+// Transform hierarchy: world matrices following their parents, and trees untouched
+// since the last run being skipped without rewriting their WorldTransforms.
+
+#include "../src/engine/ecs/include/ECSManager.h"
+#include "../src/engine/scene/include/TransformSystem.h"
+#include "Test.h"
+#include <memory>
+
+namespace
+{
+	// Keeps an entity out of the other nodes' archetype, and so out of their chunks. An
+	// empty component would be stored as a tag and leave the archetype unchanged.
+	struct Static : Component
+	{
+		int32_t unused = 0;
+	};
+
+	Entity CreateNode(ECSManager& world, float x, const Entity* parent = nullptr)
+	{
+		Entity entity = world.CreateEntity();
+		Transform transform;
+		transform.position = { x, 0.0f, 0.0f };
+		world.AddComponent<Transform>(entity, transform);
+		if (parent)
+		{
+			world.AddComponent<Parent>(entity, Parent(*parent));
+		}
+		return entity;
+	}
+
+	float WorldX(ECSManager& world, Entity entity)
+	{
+		const WorldTransform* transform = world.ReadComponent<WorldTransform>(entity);
+		return transform ? transform->matrix.GetTranslation().x : -1.0f;
+	}
+}
+
+TEST(TransformSystemPropagatesToDirtyTrees)
+{
+	ECSManager world;
+	world.AddSystem(std::make_shared<TransformSystem>());
+
+	// Two trees, root -> child -> grandchild and a lone root.
+	Entity root = CreateNode(world, 1.0f);
+	Entity child = CreateNode(world, 2.0f, &root);
+	Entity grandchild = CreateNode(world, 4.0f, &child);
+	Entity other = CreateNode(world, 8.0f);
+
+	// The first run adds WorldTransforms through the command buffer.
+	world.UpdateSystems(0.0f);
+	CHECK(WorldX(world, root) == 1.0f);
+	CHECK(WorldX(world, child) == 3.0f);
+	CHECK(WorldX(world, grandchild) == 7.0f);
+	CHECK(WorldX(world, other) == 8.0f);
+
+	// Settle, then a static frame writes nothing.
+	world.UpdateSystems(0.0f);
+	world.UpdateSystems(0.0f);
+	const uint32_t settled = world.GetComponentVersion<WorldTransform>(root);
+	world.UpdateSystems(0.0f);
+	CHECK(world.GetComponentVersion<WorldTransform>(root) == settled);
+
+	// Moving a mid-tree node carries its descendants and leaves its parent in place.
+	world.GetComponent<Transform>(child)->position.x = 5.0f;
+	world.UpdateSystems(0.0f);
+	CHECK(WorldX(world, root) == 1.0f);
+	CHECK(WorldX(world, child) == 6.0f);
+	CHECK(WorldX(world, grandchild) == 10.0f);
+	CHECK(WorldX(world, other) == 8.0f);
+
+	// Moving a root leaves trees in other chunks unwritten.
+	Entity lone = CreateNode(world, 0.0f);
+	world.AddComponent<Static>(lone);
+	world.UpdateSystems(0.0f);
+	world.UpdateSystems(0.0f);
+	world.UpdateSystems(0.0f);
+	const uint32_t untouched = world.GetComponentVersion<WorldTransform>(lone);
+	world.GetComponent<Transform>(root)->position.x = 0.0f;
+	world.UpdateSystems(0.0f);
+	CHECK(WorldX(world, grandchild) == 9.0f);
+	CHECK(world.GetComponentVersion<WorldTransform>(lone) == untouched);
+
+	// Reparenting and losing a parent are picked up without any Transform change.
+	world.GetComponent<Parent>(grandchild)->entity = other;
+	world.UpdateSystems(0.0f);
+	CHECK(WorldX(world, grandchild) == 12.0f);
+	world.RemoveComponent<Parent>(grandchild);
+	world.UpdateSystems(0.0f);
+	CHECK(WorldX(world, grandchild) == 4.0f);
+
+	// A destroyed parent turns its child into a root.
+	world.DestroyEntity(root);
+	world.UpdateSystems(0.0f);
+	CHECK(WorldX(world, child) == 5.0f);
+}
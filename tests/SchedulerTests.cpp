@@ -0,0 +1,302 @@
+// Systems: those whose declared access conflicts keeping their registration order,
+// undeclared systems running alone, the stages of the computed schedule, entity sets
+// following the components their members gain and lose, and system groups running at
+// their own rate, a slice of their entities at a time, within a CPU budget.
+
+#include "../src/engine/ecs/include/ECSManager.h"
+#include "Test.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	struct Velocity : Component
+	{
+		float x = 0.0f;
+	};
+
+	struct Health : Component
+	{
+		int32_t value = 0;
+	};
+
+	struct Frozen : Component
+	{
+		static constexpr ComponentStorage Storage = ComponentStorage::Tag;
+	};
+
+	struct Cooldown : Component
+	{
+		static constexpr ComponentStorage Storage = ComponentStorage::SparseSet;
+		int32_t frames = 0;
+	};
+
+	enum class Access
+	{
+		ReadVelocity,
+		WriteVelocity,
+		WriteHealth,
+		Undeclared
+	};
+
+	// Stamps the start and end of each run from a clock shared by all systems, holding
+	// the run open long enough for overlapping systems to interleave.
+	class TimedSystem : public System
+	{
+	public:
+		TimedSystem(std::atomic<int>& clock, Access access)
+			: clock(clock)
+		{
+			switch (access)
+			{
+			case Access::ReadVelocity:
+				Reads<Velocity>();
+				break;
+			case Access::WriteVelocity:
+				Writes<Velocity>();
+				break;
+			case Access::WriteHealth:
+				Writes<Health>();
+				break;
+			case Access::Undeclared:
+				break;
+			}
+		}
+
+		void Update(float) override
+		{
+			start = clock.fetch_add(1);
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+			end = clock.fetch_add(1);
+		}
+
+		bool Before(const TimedSystem& other) const { return end < other.start; }
+
+		int start = -1;
+		int end = -1;
+
+	private:
+		std::atomic<int>& clock;
+	};
+
+	template <typename... Ts>
+	class MatchingSystem : public System
+	{
+	public:
+		MatchingSystem() { Requires<Ts...>(); }
+
+		void Update(float) override {}
+
+		bool Has(Entity entity) const
+		{
+			return std::count(GetEntities().begin(), GetEntities().end(), entity) == 1;
+		}
+	};
+
+	// Records each run's delta and slice, optionally taking longer than a budget allows.
+	class GroupedSystem : public System
+	{
+	public:
+		GroupedSystem() { Requires<Health>(); }
+
+		void Update(float deltaTime) override
+		{
+			deltas.push_back(deltaTime);
+			for (Entity entity : GetSliceEntities())
+			{
+				visited.push_back(entity);
+			}
+			if (slow)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			}
+		}
+
+		std::vector<float> deltas;
+		std::vector<Entity> visited;
+		bool slow = false;
+	};
+}
+
+TEST(SchedulerOrdersConflictingSystems)
+{
+	ECSManager world;
+	world.SetWorkerCount(3);
+	std::atomic<int> clock{ 0 };
+	auto add = [&](Access access)
+	{
+		auto system = std::make_shared<TimedSystem>(clock, access);
+		world.AddSystem(system);
+		return system;
+	};
+	auto write = add(Access::WriteVelocity);
+	auto read = add(Access::ReadVelocity);
+	auto otherRead = add(Access::ReadVelocity);
+	auto independent = add(Access::WriteHealth);
+	auto writeAgain = add(Access::WriteVelocity);
+	auto undeclared = add(Access::Undeclared);
+	auto last = add(Access::ReadVelocity);
+	const std::vector<std::shared_ptr<TimedSystem>> all = { write, read, otherRead, independent, writeAgain, undeclared, last };
+
+	for (int frame = 0; frame < 20; ++frame)
+	{
+		world.UpdateSystems(0.0f);
+		for (const auto& system : all)
+		{
+			CHECK(system->start >= 0 && system->start < system->end);
+		}
+		// Readers wait for the writer before them, and the next writer waits for both.
+		CHECK(write->Before(*read) && write->Before(*otherRead));
+		CHECK(read->Before(*writeAgain) && otherRead->Before(*writeAgain));
+		// A system without declared access conflicts with everything.
+		for (const auto& system : all)
+		{
+			if (system != undeclared)
+			{
+				CHECK(system == last ? undeclared->Before(*system) : system->Before(*undeclared));
+			}
+		}
+		clock.store(0);
+	}
+
+	// Stages: write and independent, both readers, writeAgain, undeclared, last.
+	std::ostringstream dump;
+	world.DumpSchedule(dump);
+	CHECK(dump.str().find("7 systems in 5 stages") != std::string::npos);
+}
+
+TEST(SystemEntitiesFollowSignatures)
+{
+	ECSManager world;
+	auto movers = std::make_shared<MatchingSystem<Velocity, Health>>();
+	auto frozen = std::make_shared<MatchingSystem<Velocity, Frozen, Cooldown>>();
+	world.AddSystem(movers);
+
+	Entity both = world.CreateEntity();
+	world.AddComponent<Velocity>(both);
+	world.AddComponent<Health>(both);
+	Entity velocityOnly = world.CreateEntity();
+	world.AddComponent<Velocity>(velocityOnly);
+	Entity destroyed = world.CreateEntity();
+	world.AddComponent<Velocity>(destroyed);
+	world.AddComponent<Health>(destroyed);
+	world.DestroyEntity(destroyed);
+	world.RefreshSystemEntities();
+	CHECK(movers->GetEntities().size() == 1 && movers->Has(both));
+
+	// Changes are batched until the next refresh.
+	world.AddComponent<Health>(velocityOnly);
+	CHECK(movers->GetEntities().size() == 1);
+	world.RefreshSystemEntities();
+	CHECK(movers->GetEntities().size() == 2 && movers->Has(velocityOnly));
+
+	world.RemoveComponent<Velocity>(both);
+	world.RefreshSystemEntities();
+	CHECK(movers->GetEntities().size() == 1 && !movers->Has(both));
+
+	// A reused slot holds the new entity, never the destroyed one's handle.
+	world.DestroyEntity(velocityOnly);
+	Entity reused = world.CreateEntity();
+	world.AddComponent<Velocity>(reused);
+	world.AddComponent<Health>(reused);
+	CHECK(reused.GetId() == velocityOnly.GetId());
+	world.RefreshSystemEntities();
+	CHECK(movers->GetEntities().size() == 1 && movers->Has(reused) && !movers->Has(velocityOnly));
+
+	// Tags and sparse-set components count towards the signature too, and a system
+	// added later starts with every entity that already matches.
+	world.AddComponent<Frozen>(reused);
+	world.AddComponent<Cooldown>(reused);
+	world.AddComponent<Frozen>(both);
+	world.AddComponent<Cooldown>(both);
+	world.AddSystem(frozen);
+	world.UpdateSystems(0.0f);
+	CHECK(frozen->GetEntities().size() == 1 && frozen->Has(reused));
+	world.RemoveComponent<Frozen>(reused);
+	world.AddComponent<Velocity>(both);
+	world.RefreshSystemEntities();
+	CHECK(frozen->GetEntities().size() == 1 && frozen->Has(both));
+	world.RemoveComponent<Cooldown>(both);
+	world.RefreshSystemEntities();
+	CHECK(frozen->GetEntities().empty());
+}
+
+TEST(SystemGroupsSliceWithinBudget)
+{
+	ECSManager world;
+	std::vector<Entity> entities;
+	for (int i = 0; i < 100; ++i)
+	{
+		entities.push_back(world.CreateEntity());
+		world.AddComponent<Health>(entities.back());
+	}
+
+	SystemGroupSettings lowRate;
+	lowRate.tickRate = 10.0f;
+	auto ticked = std::make_shared<GroupedSystem>();
+	world.AddSystem(ticked, world.AddSystemGroup("LowRate", lowRate));
+
+	SystemGroupSettings sliced;
+	sliced.slices = 4;
+	auto slicedSystem = std::make_shared<GroupedSystem>();
+	world.AddSystem(slicedSystem, world.AddSystemGroup("Sliced", sliced));
+
+	SystemGroupSettings budgeted;
+	budgeted.budgetMilliseconds = 2.0f;
+	auto expensive = std::make_shared<GroupedSystem>();
+	const SystemGroupId budgetedGroup = world.AddSystemGroup("Budgeted", budgeted);
+	world.AddSystem(expensive, budgetedGroup);
+
+	// One simulated second at 100 updates: the low-rate group runs about ten times, each
+	// seeing the time since its previous run.
+	for (int frame = 0; frame < 100; ++frame)
+	{
+		world.UpdateSystems(0.01f);
+	}
+	CHECK(ticked->deltas.size() >= 9 && ticked->deltas.size() <= 11);
+	for (size_t i = 1; i < ticked->deltas.size(); ++i)
+	{
+		CHECK(std::fabs(ticked->deltas[i] - 0.1f) < 0.011f);
+	}
+
+	// Four consecutive runs of the sliced group cover every entity exactly once, each
+	// slice seeing four frames' worth of time.
+	slicedSystem->visited.clear();
+	slicedSystem->deltas.clear();
+	for (int frame = 0; frame < 4; ++frame)
+	{
+		world.UpdateSystems(0.01f);
+	}
+	std::vector<Entity> visited = slicedSystem->visited;
+	std::sort(visited.begin(), visited.end(), [](Entity a, Entity b) { return a.GetId() < b.GetId(); });
+	CHECK(visited == entities);
+	CHECK(std::fabs(slicedSystem->deltas.back() - 0.04f) < 1e-4f);
+
+	// Running over budget doubles the slice count until a run fits, up to the maximum;
+	// running well under it halves the count back to the configured one.
+	const SystemGroupStats& stats = world.GetSystemGroups().GetStats(budgetedGroup);
+	const uint64_t overBudgetBefore = stats.overBudgetRuns;
+	uint32_t slices = stats.slices;
+	expensive->slow = true;
+	for (int frame = 0; frame < 8; ++frame)
+	{
+		world.UpdateSystems(0.01f);
+		CHECK(stats.slices == std::min(slices * 2, SystemGroups::MaxSlices));
+		slices = stats.slices;
+	}
+	CHECK(stats.overBudgetRuns - overBudgetBefore == 8);
+	CHECK(slices == SystemGroups::MaxSlices);
+	// A few spare runs, in case the machine stalls one of them.
+	expensive->slow = false;
+	for (int frame = 0; frame < 12; ++frame)
+	{
+		world.UpdateSystems(0.01f);
+	}
+	CHECK(stats.slices == 1);
+}
@@ -0,0 +1,341 @@
+// World persistence: snapshot save/load round trips, corrupt snapshots being rejected
+// without touching the world, and rollback restoring earlier ticks exactly.
+
+#include "../src/engine/ecs/include/ECSManager.h"
+#include "../src/engine/ecs/include/RollbackBuffer.h"
+#include "../src/engine/ecs/include/WorldSnapshot.h"
+#include "Test.h"
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Snapshots match component types by name, so these must not share names with the
+// other test files' components.
+namespace SnapshotTests
+{
+	struct Position : Component
+	{
+		static constexpr bool Persistent = true;
+		float x = 0.0f, y = 0.0f, z = 0.0f;
+	};
+
+	struct Target : Component
+	{
+		static constexpr bool Persistent = true;
+		Entity entity = Entity(0, 0);
+	};
+
+	struct Cooldown : Component
+	{
+		static constexpr ComponentStorage Storage = ComponentStorage::SparseSet;
+		static constexpr bool Persistent = true;
+		int32_t frames = 0;
+	};
+
+	struct Frozen : Component
+	{
+		static constexpr ComponentStorage Storage = ComponentStorage::Tag;
+	};
+
+	// Trivially copyable, but meaningless in another process.
+	struct Undeclared : Component
+	{
+		int32_t* data = nullptr;
+	};
+
+	struct Transient : Component
+	{
+		static constexpr bool Persistent = false;
+		int32_t* data = nullptr;
+	};
+
+	// Mirrors the header WorldSnapshot writes, to corrupt individual fields.
+	struct SnapshotHeader
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t endianTag;
+		uint32_t handleBytes;
+		uint32_t typeCount;
+		uint32_t recordCount;
+		uint32_t freeCount;
+		uint32_t archetypeCount;
+		uint32_t sparseCount;
+		uint64_t fileSize;
+		uint64_t typesOffset;
+		uint64_t namesOffset;
+		uint64_t generationsOffset;
+		uint64_t freeOffset;
+		uint64_t archetypesOffset;
+		uint64_t sparseOffset;
+	};
+}
+
+namespace
+{
+	using namespace SnapshotTests;
+
+	using Bytes = std::vector<char>;
+
+	std::string TempPath(const char* name)
+	{
+		return (std::filesystem::temp_directory_path() / name).string();
+	}
+
+	Bytes ReadFile(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		return Bytes(std::istreambuf_iterator<char>(file), {});
+	}
+
+	void WriteFile(const std::string& path, const Bytes& bytes)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+	}
+
+	// Snapshots are deterministic, so equal worlds save to equal bytes.
+	Bytes SaveBytes(const ECSManager& world, const std::string& path)
+	{
+		return WorldSnapshot::Save(world, path) ? ReadFile(path) : Bytes();
+	}
+
+	// Entities with archetype, sparse and tag components, cross references and a free list.
+	std::vector<Entity> Populate(ECSManager& world, int count)
+	{
+		std::vector<Entity> entities;
+		for (int i = 0; i < count; ++i)
+		{
+			Entity entity = world.CreateEntity();
+			world.AddComponent<Position>(entity).x = static_cast<float>(i);
+			if (i % 3 == 0)
+			{
+				world.AddComponent<Cooldown>(entity).frames = i;
+			}
+			if (i % 5 == 0)
+			{
+				world.AddComponent<Frozen>(entity);
+			}
+			if (i > 0 && i % 2 == 0)
+			{
+				world.AddComponent<Target>(entity).entity = entities[i - 1];
+			}
+			entities.push_back(entity);
+		}
+		for (int i = 7; i < count; i += 11)
+		{
+			world.DestroyEntity(entities[i]);
+		}
+		return entities;
+	}
+
+	template <typename T>
+	void Poke(Bytes& bytes, size_t offset, T value)
+	{
+		std::memcpy(bytes.data() + offset, &value, sizeof(T));
+	}
+
+	template <typename T>
+	T Peek(const Bytes& bytes, size_t offset)
+	{
+		T value;
+		std::memcpy(&value, bytes.data() + offset, sizeof(T));
+		return value;
+	}
+}
+
+TEST(SnapshotSaveLoadRoundTrip)
+{
+	const std::string path = TempPath("engine_tests_round_trip.snap");
+	ECSManager source;
+	const std::vector<Entity> entities = Populate(source, 2000);
+	const Bytes saved = SaveBytes(source, path);
+	CHECK(!saved.empty());
+
+	ECSManager loaded;
+	loaded.AddComponent<Position>(loaded.CreateEntity()).x = -1.0f;
+	CHECK(WorldSnapshot::Load(loaded, path));
+	CHECK(loaded.GetEntityCount() == source.GetEntityCount());
+
+	for (size_t i = 0; i < entities.size(); ++i)
+	{
+		Entity entity = entities[i];
+		CHECK(loaded.IsAlive(entity) == source.IsAlive(entity));
+		if (!source.IsAlive(entity))
+		{
+			continue;
+		}
+		const Position* position = loaded.ReadComponent<Position>(entity);
+		CHECK(position && position->x == static_cast<float>(i));
+		const Cooldown* cooldown = loaded.ReadComponent<Cooldown>(entity);
+		CHECK((cooldown != nullptr) == (i % 3 == 0));
+		if (cooldown)
+		{
+			CHECK(cooldown->frames == static_cast<int32_t>(i));
+		}
+		CHECK(loaded.HasComponent<Frozen>(entity) == (i % 5 == 0));
+		const Target* target = loaded.ReadComponent<Target>(entity);
+		CHECK((target != nullptr) == (i > 0 && i % 2 == 0));
+		if (target)
+		{
+			CHECK(target->entity == entities[i - 1]);
+		}
+	}
+
+	CHECK(SaveBytes(loaded, path) == saved);
+
+	// The free list and generations come back too, so both worlds hand out the same
+	// next handle and it differs from every destroyed one.
+	Entity fresh = loaded.CreateEntity();
+	CHECK(fresh == source.CreateEntity());
+	for (Entity entity : entities)
+	{
+		CHECK(!(fresh == entity) || source.IsAlive(entity));
+	}
+	std::filesystem::remove(path);
+}
+
+TEST(SnapshotRejectsCorruptFiles)
+{
+	const std::string path = TempPath("engine_tests_source.snap");
+	const std::string corruptPath = TempPath("engine_tests_corrupt.snap");
+	ECSManager source;
+	const std::vector<Entity> entities = Populate(source, 500);
+	const Bytes good = SaveBytes(source, path);
+	CHECK(good.size() > sizeof(SnapshotHeader));
+	if (good.size() <= sizeof(SnapshotHeader))
+	{
+		return;
+	}
+
+	ECSManager world;
+	Entity keep = world.CreateEntity();
+	world.AddComponent<Position>(keep).x = 42.0f;
+	auto rejects = [&](Bytes bytes)
+	{
+		WriteFile(corruptPath, bytes);
+		const bool loaded = WorldSnapshot::Load(world, corruptPath);
+		const Position* position = world.ReadComponent<Position>(keep);
+		return !loaded && world.GetEntityCount() == 1 && position && position->x == 42.0f;
+	};
+
+	const size_t generations = Peek<uint64_t>(good, offsetof(SnapshotHeader, generationsOffset));
+	const size_t freeList = Peek<uint64_t>(good, offsetof(SnapshotHeader, freeOffset));
+	const uint32_t recordCount = Peek<uint32_t>(good, offsetof(SnapshotHeader, recordCount));
+	{
+		Bytes bytes = good;
+		bytes.resize(bytes.size() - 8);
+		CHECK(rejects(bytes));
+	}
+	{
+		Bytes bytes = good;
+		bytes[0] ^= 0x5a;
+		CHECK(rejects(bytes));
+	}
+	{
+		Bytes bytes = good;
+		Poke<uint32_t>(bytes, offsetof(SnapshotHeader, version), WorldSnapshot::FormatVersion + 1);
+		CHECK(rejects(bytes));
+	}
+	{
+		Bytes bytes = good;
+		Poke<uint32_t>(bytes, offsetof(SnapshotHeader, freeCount), 1u << 30);
+		CHECK(rejects(bytes));
+	}
+	{
+		Bytes bytes = good;
+		Poke<uint32_t>(bytes, freeList, recordCount + 5);
+		CHECK(rejects(bytes));
+	}
+	{
+		// A free slot that a live entity still occupies.
+		Bytes bytes = good;
+		Poke<uint32_t>(bytes, freeList, entities[1].GetId());
+		CHECK(rejects(bytes));
+	}
+	{
+		// A stored handle whose generation no longer matches its slot.
+		Bytes bytes = good;
+		const size_t slot = generations + sizeof(uint32_t) * entities[1].GetId();
+		Poke<uint32_t>(bytes, slot, Peek<uint32_t>(bytes, slot) + 1);
+		CHECK(rejects(bytes));
+	}
+	CHECK(!WorldSnapshot::Load(world, TempPath("engine_tests_missing.snap")));
+
+	CHECK(WorldSnapshot::Load(world, path));
+	CHECK(world.GetEntityCount() == source.GetEntityCount());
+	std::filesystem::remove(path);
+	std::filesystem::remove(corruptPath);
+}
+
+TEST(RollbackRestoresEarlierTicks)
+{
+	const std::string path = TempPath("engine_tests_rollback.snap");
+	ECSManager world;
+	std::vector<Entity> entities = Populate(world, 1000);
+	RollbackBuffer rollback(8);
+
+	// Each tick moves some entities, destroys one and creates one, so frames differ in
+	// component data, structure and the free list.
+	std::vector<Bytes> expected;
+	for (uint64_t tick = 0; tick < 12; ++tick)
+	{
+		CHECK(rollback.Save(world, tick));
+		expected.push_back(SaveBytes(world, path));
+
+		world.Each<Position>([&](Entity entity, Position& position)
+		{
+			if (entity.GetId() % 4 == tick % 4)
+			{
+				position.y += 1.0f;
+			}
+		});
+		world.DestroyEntity(entities[tick * 13 + 2]);
+		Entity entity = world.CreateEntity();
+		world.AddComponent<Position>(entity).z = static_cast<float>(tick);
+		world.AddComponent<Cooldown>(entity).frames = static_cast<int32_t>(tick);
+		entities.push_back(entity);
+	}
+
+	CHECK(!rollback.Contains(3));
+	CHECK(!rollback.Restore(world, 3));
+	for (uint64_t tick : { 11u, 6u, 9u, 4u })
+	{
+		CHECK(rollback.Restore(world, tick));
+		CHECK(SaveBytes(world, path) == expected[tick]);
+	}
+
+	// Saving after a restore replaces the discarded future.
+	world.Each<Position>([](Entity, Position& position) { position.x = 0.0f; });
+	CHECK(rollback.Save(world, 5));
+	CHECK(!rollback.Contains(6));
+	CHECK(rollback.Restore(world, 4));
+	CHECK(SaveBytes(world, path) == expected[4]);
+	std::filesystem::remove(path);
+}
+
+TEST(SnapshotSavesOnlyPersistentComponents)
+{
+	const std::string path = TempPath("engine_tests_persistence.snap");
+	int32_t value = 0;
+	ECSManager world;
+	Entity entity = world.CreateEntity();
+	world.AddComponent<Position>(entity).x = 3.0f;
+	world.AddComponent<Transient>(entity).data = &value;
+	CHECK(WorldSnapshot::Save(world, path));
+
+	ECSManager loaded;
+	CHECK(WorldSnapshot::Load(loaded, path));
+	CHECK(loaded.ReadComponent<Position>(entity) && loaded.ReadComponent<Position>(entity)->x == 3.0f);
+	CHECK(!loaded.HasComponent<Transient>(entity));
+
+	// A component that has not said whether it may be saved fails the whole save.
+	std::filesystem::remove(path);
+	world.AddComponent<Undeclared>(entity).data = &value;
+	CHECK(!WorldSnapshot::Save(world, path));
+	CHECK(!std::filesystem::exists(path));
+}
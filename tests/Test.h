@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+// Minimal test registry. TEST(Name) defines a test and registers it under Name; CHECK
+// reports a failed expression and lets the test carry on, so one run lists every failure.
+struct TestCase
+{
+	const char* name;
+	void (*run)();
+};
+
+struct TestRegistrar
+{
+	TestRegistrar(const char* name, void (*run)());
+};
+
+void ReportFailure(const char* file, int line, const char* expression);
+
+#define TEST(name) \
+	static void name(); \
+	static TestRegistrar name##Registrar(#name, name); \
+	static void name()
+
+#define CHECK(...) \
+	do \
+	{ \
+		if (!(__VA_ARGS__)) \
+		{ \
+			ReportFailure(__FILE__, __LINE__, #__VA_ARGS__); \
+		} \
+	} while (0)
@@ -0,0 +1,62 @@
+// Runs the registered tests, or only those named on the command line.
+// Usage: engine_tests [TestName...]
+
+#include "Test.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+	std::vector<TestCase>& Tests()
+	{
+		static std::vector<TestCase> tests;
+		return tests;
+	}
+
+	size_t failures = 0;
+}
+
+TestRegistrar::TestRegistrar(const char* name, void (*run)())
+{
+	Tests().push_back({ name, run });
+}
+
+void ReportFailure(const char* file, int line, const char* expression)
+{
+	std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+	++failures;
+}
+
+int main(int argc, char** argv)
+{
+	size_t run = 0;
+	size_t failed = 0;
+	for (const TestCase& test : Tests())
+	{
+		bool selected = argc < 2;
+		for (int i = 1; i < argc && !selected; ++i)
+		{
+			selected = std::strcmp(argv[i], test.name) == 0;
+		}
+		if (!selected)
+		{
+			continue;
+		}
+
+		const size_t before = failures;
+		test.run();
+		++run;
+		const bool passed = failures == before;
+		failed += !passed;
+		std::printf("%-32s %s\n", test.name, passed ? "ok" : "FAILED");
+	}
+
+	if (run == 0)
+	{
+		std::fprintf(stderr, "No tests matched\n");
+		return 1;
+	}
+	std::printf("%zu of %zu tests passed\n", run - failed, run);
+	return failed == 0 ? 0 : 1;
+}